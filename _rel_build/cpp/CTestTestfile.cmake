@@ -0,0 +1,11 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/cpp
+# Build directory: /root/repo/_rel_build/cpp
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("lazperf")
+subdirs("examples")
+subdirs("benchmarks")
+subdirs("tools")
+subdirs("test")
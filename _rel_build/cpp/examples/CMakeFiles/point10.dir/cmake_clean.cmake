@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/point10.dir/point10.cpp.o"
+  "CMakeFiles/point10.dir/point10.cpp.o.d"
+  "point10"
+  "point10.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/point10.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
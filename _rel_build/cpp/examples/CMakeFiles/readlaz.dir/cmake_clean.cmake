@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/readlaz.dir/readlaz.cpp.o"
+  "CMakeFiles/readlaz.dir/readlaz.cpp.o.d"
+  "readlaz"
+  "readlaz.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/readlaz.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
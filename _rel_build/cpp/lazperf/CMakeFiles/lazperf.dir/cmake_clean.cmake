@@ -0,0 +1,37 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/lazperf.dir/charbuf.cpp.o"
+  "CMakeFiles/lazperf.dir/charbuf.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_byte10.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_byte10.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_byte14.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_byte14.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_gpstime10.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_gpstime10.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_nir14.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_nir14.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_point10.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_point10.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_point14.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_point14.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_rgb10.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_rgb10.cpp.o.d"
+  "CMakeFiles/lazperf.dir/detail/field_rgb14.cpp.o"
+  "CMakeFiles/lazperf.dir/detail/field_rgb14.cpp.o.d"
+  "CMakeFiles/lazperf.dir/filestream.cpp.o"
+  "CMakeFiles/lazperf.dir/filestream.cpp.o.d"
+  "CMakeFiles/lazperf.dir/io.cpp.o"
+  "CMakeFiles/lazperf.dir/io.cpp.o.d"
+  "CMakeFiles/lazperf.dir/lazperf.cpp.o"
+  "CMakeFiles/lazperf.dir/lazperf.cpp.o.d"
+  "CMakeFiles/lazperf.dir/threadpool.cpp.o"
+  "CMakeFiles/lazperf.dir/threadpool.cpp.o.d"
+  "CMakeFiles/lazperf.dir/vlr.cpp.o"
+  "CMakeFiles/lazperf.dir/vlr.cpp.o.d"
+  "liblazperf.pdb"
+  "liblazperf.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/lazperf.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
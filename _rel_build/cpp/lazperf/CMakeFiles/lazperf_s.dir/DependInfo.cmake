@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/cpp/lazperf/charbuf.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/charbuf.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/charbuf.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_byte10.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_byte10.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_byte10.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_byte14.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_byte14.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_byte14.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_gpstime10.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_gpstime10.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_gpstime10.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_nir14.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_nir14.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_nir14.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_point10.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_point10.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_point10.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_point14.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_point14.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_point14.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_rgb10.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_rgb10.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_rgb10.cpp.o.d"
+  "/root/repo/cpp/lazperf/detail/field_rgb14.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_rgb14.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/detail/field_rgb14.cpp.o.d"
+  "/root/repo/cpp/lazperf/filestream.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/filestream.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/filestream.cpp.o.d"
+  "/root/repo/cpp/lazperf/io.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/io.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/io.cpp.o.d"
+  "/root/repo/cpp/lazperf/lazperf.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/lazperf.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/lazperf.cpp.o.d"
+  "/root/repo/cpp/lazperf/threadpool.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/threadpool.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/threadpool.cpp.o.d"
+  "/root/repo/cpp/lazperf/vlr.cpp" "cpp/lazperf/CMakeFiles/lazperf_s.dir/vlr.cpp.o" "gcc" "cpp/lazperf/CMakeFiles/lazperf_s.dir/vlr.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,37 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/lazperf_s.dir/charbuf.cpp.o"
+  "CMakeFiles/lazperf_s.dir/charbuf.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_byte10.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_byte10.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_byte14.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_byte14.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_gpstime10.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_gpstime10.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_nir14.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_nir14.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_point10.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_point10.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_point14.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_point14.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_rgb10.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_rgb10.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/detail/field_rgb14.cpp.o"
+  "CMakeFiles/lazperf_s.dir/detail/field_rgb14.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/filestream.cpp.o"
+  "CMakeFiles/lazperf_s.dir/filestream.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/io.cpp.o"
+  "CMakeFiles/lazperf_s.dir/io.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/lazperf.cpp.o"
+  "CMakeFiles/lazperf_s.dir/lazperf.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/threadpool.cpp.o"
+  "CMakeFiles/lazperf_s.dir/threadpool.cpp.o.d"
+  "CMakeFiles/lazperf_s.dir/vlr.cpp.o"
+  "CMakeFiles/lazperf_s.dir/vlr.cpp.o.d"
+  "liblazperf_s.a"
+  "liblazperf_s.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/lazperf_s.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/io_tests.dir/io_tests.cpp.o"
+  "CMakeFiles/io_tests.dir/io_tests.cpp.o.d"
+  "io_tests"
+  "io_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/io_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/cpp/test/lazperf_tests.cpp" "cpp/test/CMakeFiles/lazperf_tests.dir/lazperf_tests.cpp.o" "gcc" "cpp/test/CMakeFiles/lazperf_tests.dir/lazperf_tests.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rel_build/cpp/test/gtest/gtest-1.10.0/CMakeFiles/gtest.dir/DependInfo.cmake"
+  "/root/repo/_rel_build/cpp/lazperf/CMakeFiles/lazperf_s.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/lazperf_tests.dir/lazperf_tests.cpp.o"
+  "CMakeFiles/lazperf_tests.dir/lazperf_tests.cpp.o.d"
+  "lazperf_tests"
+  "lazperf_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/lazperf_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
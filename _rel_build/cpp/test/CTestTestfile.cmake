@@ -0,0 +1,13 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/cpp/test
+# Build directory: /root/repo/_rel_build/cpp/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(io_tests "/root/repo/_rel_build/cpp/test/io_tests")
+set_tests_properties(io_tests PROPERTIES  WORKING_DIRECTORY "/../.." _BACKTRACE_TRIPLES "/root/repo/cpp/test/CMakeLists.txt;9;add_test;/root/repo/cpp/test/CMakeLists.txt;16;LAZPERF_ADD_TEST;/root/repo/cpp/test/CMakeLists.txt;0;")
+add_test(lazperf_tests "/root/repo/_rel_build/cpp/test/lazperf_tests")
+set_tests_properties(lazperf_tests PROPERTIES  WORKING_DIRECTORY "/../.." _BACKTRACE_TRIPLES "/root/repo/cpp/test/CMakeLists.txt;9;add_test;/root/repo/cpp/test/CMakeLists.txt;17;LAZPERF_ADD_TEST;/root/repo/cpp/test/CMakeLists.txt;0;")
+add_test(stream_tests "/root/repo/_rel_build/cpp/test/stream_tests")
+set_tests_properties(stream_tests PROPERTIES  WORKING_DIRECTORY "/../.." _BACKTRACE_TRIPLES "/root/repo/cpp/test/CMakeLists.txt;9;add_test;/root/repo/cpp/test/CMakeLists.txt;18;LAZPERF_ADD_TEST;/root/repo/cpp/test/CMakeLists.txt;0;")
+subdirs("gtest/gtest-1.10.0")
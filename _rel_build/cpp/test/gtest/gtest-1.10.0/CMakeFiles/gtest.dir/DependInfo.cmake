@@ -0,0 +1,19 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/cpp/test/gtest/gtest-1.10.0/src/gtest-all.cc" "cpp/test/gtest/gtest-1.10.0/CMakeFiles/gtest.dir/src/gtest-all.cc.o" "gcc" "cpp/test/gtest/gtest-1.10.0/CMakeFiles/gtest.dir/src/gtest-all.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,6 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/cpp/test/gtest/gtest-1.10.0
+# Build directory: /root/repo/_rel_build/cpp/test/gtest/gtest-1.10.0
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
@@ -0,0 +1,11 @@
+#include "gtest/gtest.h"
+
+GTEST_API_ int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+std::string testFile(const std::string& filename)
+{
+    return std::string("/root/repo/cpp/test/raw-sets/") + filename;
+}
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/random.dir/random.cpp.o"
+  "CMakeFiles/random.dir/random.cpp.o.d"
+  "random"
+  "random.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/random.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -96,6 +96,18 @@ public:
         }
     }
 
+    // Return the models to their initial state so that the compressor can be
+    // reused for another chunk.
+    void reset()
+    {
+        for (auto& m : mBits)
+            m.reset();
+        mCorrector0.reset();
+        for (auto& m : mCorrector)
+            m.reset();
+        k = 0;
+    }
+
     unsigned int getK() const
     { return k; }
 
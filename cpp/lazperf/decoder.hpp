@@ -139,6 +139,12 @@ public:
         }
     }
 
+    // Restart decoding. The next bytes read must be the start of new coded data.
+    void reset()
+    {
+        init();
+    }
+
     void readInitBytes()
     {
         value =
@@ -100,6 +100,17 @@ namespace decompressors
 				}
 			}
 
+			// Return the models to their initial state so that the decompressor can be
+			// reused for another chunk.
+			void reset() {
+				for (auto& m : mBits)
+					m.reset();
+				mCorrector0.reset();
+				for (auto& m : mCorrector)
+					m.reset();
+				k = 0;
+			}
+
 			template<
 				typename TDecoder
 			>
@@ -26,6 +26,7 @@
 
 #include "../las.hpp"
 
+#include <algorithm>
 #include <deque>
 
 namespace lazperf
@@ -37,6 +38,15 @@ Byte10Base::Byte10Base(size_t count) : count_(count), have_last_(false),
     lasts_(count), diffs_(count), models_(count, models::arithmetic(256))
 {}
 
+void Byte10Base::reset()
+{
+    have_last_ = false;
+    std::fill(lasts_.begin(), lasts_.end(), 0);
+    std::fill(diffs_.begin(), diffs_.end(), 0);
+    for (auto& m : models_)
+        m.reset();
+}
+
 // COMPRESSOR
 
 Byte10Compressor::Byte10Compressor(encoders::arithmetic<OutCbStream>& encoder, size_t count) :
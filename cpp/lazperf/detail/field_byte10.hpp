@@ -34,6 +34,8 @@ class Byte10Base
 protected:
     Byte10Base(size_t count);
 
+    void reset();
+
     size_t count_;
     bool have_last_;
     std::vector<uint8_t> lasts_;
@@ -47,6 +49,7 @@ public:
     Byte10Compressor(encoders::arithmetic<OutCbStream>& encoder, size_t count);
 
     const char *compress(const char *buf);
+    using Byte10Base::reset;
 
 private:
     encoders::arithmetic<OutCbStream>& enc_;
@@ -58,6 +61,7 @@ public:
     Byte10Decompressor(decoders::arithmetic<InCbStream>& decoder, size_t count);
 
     char *decompress(char *buf);
+    using Byte10Base::reset;
 
 private:
     decoders::arithmetic<InCbStream>& dec_;
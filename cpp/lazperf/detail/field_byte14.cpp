@@ -35,8 +35,7 @@ namespace lazperf
 namespace detail
 {
 
-Byte14Base::Byte14Base(size_t count) : count_(count), last_channel_(-1),
-    chan_ctxs_ { count_, count_, count_, count_ }
+Byte14Base::Byte14Base(size_t count) : count_(count), last_channel_(-1)
 {}
 
 size_t Byte14Base::count() const
@@ -44,6 +43,12 @@ size_t Byte14Base::count() const
     return count_;
 }
 
+void Byte14Base::reset()
+{
+    chan_ctxs_.forEach([](ChannelCtx& c){ c.reset(); });
+    last_channel_ = -1;
+}
+
 // COMPRESSOR
 
 Byte14Compressor::Byte14Compressor(OutCbStream& stream, size_t count) :
@@ -79,20 +84,31 @@ void Byte14Compressor::writeData()
     LAZDEBUG(std::cerr << "BYTE      : " << total << "\n");
 }
 
+void Byte14Compressor::reset()
+{
+    Byte14Base::reset();
+    std::fill(valid_.begin(), valid_.end(), false);
+    for (auto& e : byte_enc_)
+    {
+        e.reset();
+        e.getOutStream().clear();
+    }
+}
+
 const char *Byte14Compressor::compress(const char *buf, int& sc)
 {
     // don't have the first data yet, just push it to our
     // have last stuff and move on
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc, count_);
         stream_.putBytes((const unsigned char *)buf, count_);
         c.last_.assign(buf, buf + count_);
         c.have_last_ = true;
         last_channel_ = sc;
         return buf + count_;
     }
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc, count_);
     las::byte14 *pLastBytes = &chan_ctxs_[last_channel_].last_;
     if (!c.have_last_)
     {
@@ -121,8 +137,9 @@ const char *Byte14Compressor::compress(const char *buf, int& sc)
 
 // DECOMPRESSOR
 
-Byte14Decompressor::Byte14Decompressor(InCbStream& stream, size_t count) : Byte14Base(count),
-    stream_(stream), byte_cnt_(count_), byte_dec_(count_, decoders::arithmetic<MemoryStream>())
+Byte14Decompressor::Byte14Decompressor(InCbStream& stream, size_t count, uint32_t layers) :
+    Byte14Base(count), stream_(stream), byte_cnt_(count_), decode_(layers & layer::ExtraBytes),
+    byte_dec_(count_, decoders::arithmetic<MemoryStream>())
 {}
 
 void Byte14Decompressor::readSizes()
@@ -134,7 +151,15 @@ void Byte14Decompressor::readSizes()
 void Byte14Decompressor::readData()
 {
     for (size_t i = 0; i < count_; ++i)
+    {
+        // Skipped data is treated as unchanged.
+        if (!decode_)
+        {
+            stream_.skipBytes(byte_cnt_[i]);
+            byte_cnt_[i] = 0;
+        }
         byte_dec_[i].initStream(stream_, byte_cnt_[i]);
+    }
 }
 
 void Byte14Decompressor::dumpSums()
@@ -142,11 +167,21 @@ void Byte14Decompressor::dumpSums()
     std::cout << "BYTE     : " << sumByte.value() << "\n";
 }
 
+void Byte14Decompressor::reset()
+{
+    Byte14Base::reset();
+    for (auto& d : byte_dec_)
+    {
+        d.reset();
+        d.getInStream().clear();
+    }
+}
+
 char *Byte14Decompressor::decompress(char *buf, int& sc)
 {
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc, count_);
         stream_.getBytes((unsigned char *)buf, count_);
         c.last_.assign(buf, buf + count_);
         c.have_last_ = true;
@@ -154,7 +189,7 @@ char *Byte14Decompressor::decompress(char *buf, int& sc)
         return buf + count_;
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc, count_);
     las::byte14 *pLastByte = &chan_ctxs_[last_channel_].last_;
     if (sc != last_channel_)
     {
@@ -45,6 +45,14 @@ protected:
         ChannelCtx(size_t count) : have_last_(false), last_(count),
             byte_model_(count, models::arithmetic(256))
         {}
+
+        void reset()
+        {
+            have_last_ = false;
+            std::fill(last_.begin(), last_.end(), 0);
+            for (auto& m : byte_model_)
+                m.reset();
+        }
     };
 
 public:
@@ -53,9 +61,11 @@ public:
 protected:
     Byte14Base(size_t count);
 
+    void reset();
+
     size_t count_;
     int last_channel_;
-    std::array<ChannelCtx, 4> chan_ctxs_;
+    utils::lazy_array<ChannelCtx, 4> chan_ctxs_;
     std::vector<decoders::arithmetic<MemoryStream>> byte_dec_;
 };
 
@@ -67,6 +77,7 @@ public:
     void writeSizes();
     void writeData();
     const char *compress(const char *buf, int& sc);
+    void reset();
 
 private:
     OutCbStream& stream_;
@@ -77,16 +88,18 @@ private:
 class Byte14Decompressor : public Byte14Base
 {
 public:
-    Byte14Decompressor(InCbStream& stream, size_t count);
+    Byte14Decompressor(InCbStream& stream, size_t count, uint32_t layers);
 
     void dumpSums();
     void readSizes();
     void readData();
     char *decompress(char *buf, int& sc);
+    void reset();
 
 private:
     InCbStream& stream_;
     std::vector<uint32_t> byte_cnt_;
+    bool decode_;
     std::vector<decoders::arithmetic<MemoryStream>> byte_dec_;
     utils::Summer sumByte;
 };
@@ -51,6 +51,18 @@ Gpstime10Base::Gpstime10Base() : have_last_(false), m_gpstime_multi(LASZIP_GPSTI
     multi_extreme_counter.fill(0);
 }
 
+void Gpstime10Base::reset()
+{
+    have_last_ = false;
+    m_gpstime_multi.reset();
+    m_gpstime_0diff.reset();
+    last = 0;
+    next = 0;
+    last_gpstime.fill(las::gpstime());
+    last_gpstime_diff.fill(0);
+    multi_extreme_counter.fill(0);
+}
+
 Gpstime10Compressor::Gpstime10Compressor(encoders::arithmetic<OutCbStream>& encoder) :
     enc_(encoder), compressor_inited_(false), ic_gpstime(32, 9)
 {}
@@ -60,6 +72,12 @@ void Gpstime10Compressor::init()
     ic_gpstime.init();
 }
 
+void Gpstime10Compressor::reset()
+{
+    Gpstime10Base::reset();
+    ic_gpstime.reset();
+}
+
 const char *Gpstime10Compressor::compress(const char *buf)
 {
     las::gpstime this_val(buf);
@@ -265,6 +283,12 @@ void Gpstime10Decompressor::init()
     ic_gpstime.init();
 }
 
+void Gpstime10Decompressor::reset()
+{
+    Gpstime10Base::reset();
+    ic_gpstime.reset();
+}
+
 char *Gpstime10Decompressor::decompress(char *buf)
 {
     if (!decompressor_inited_)
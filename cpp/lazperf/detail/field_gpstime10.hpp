@@ -38,6 +38,8 @@ class Gpstime10Base
 protected:
     Gpstime10Base();
 
+    void reset();
+
     bool have_last_;
     models::arithmetic m_gpstime_multi, m_gpstime_0diff;
     unsigned int last;
@@ -53,6 +55,7 @@ public:
     Gpstime10Compressor(encoders::arithmetic<OutCbStream>&);
 
     const char *compress(const char *c);
+    void reset();
 
 private:
     void init();
@@ -68,6 +71,7 @@ public:
     Gpstime10Decompressor(decoders::arithmetic<InCbStream>&);
 
     char *decompress(char *c);
+    void reset();
 
 private:
     void init();
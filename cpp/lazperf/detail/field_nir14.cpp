@@ -52,6 +52,13 @@ void Nir14Compressor::writeData()
         stream_.putBytes(nir_enc_.encoded_bytes(), nir_enc_.num_encoded());
 }
 
+void Nir14Compressor::reset()
+{
+    Nir14Base::reset();
+    nir_enc_.reset();
+    nir_enc_.getOutStream().clear();
+}
+
 const char *Nir14Compressor::compress(const char *buf, int& sc)
 {
     const las::nir14 nir(buf);
@@ -60,7 +67,7 @@ const char *Nir14Compressor::compress(const char *buf, int& sc)
     // have last stuff and move on
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc);
         stream_.putBytes((const unsigned char*)&nir, sizeof(las::nir14));
         c.last_ = nir;
         c.have_last_ = true;
@@ -68,7 +75,7 @@ const char *Nir14Compressor::compress(const char *buf, int& sc)
         return buf + sizeof(las::nir14);
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     las::nir14 *pLastNir = &chan_ctxs_[last_channel_].last_;
     if (!c.have_last_)
     {
@@ -117,14 +124,27 @@ void Nir14Decompressor::readSizes()
 
 void Nir14Decompressor::readData()
 {
+    // Skipped data is treated as unchanged.
+    if (!decode_)
+    {
+        stream_.skipBytes(nir_cnt_);
+        nir_cnt_ = 0;
+    }
     nir_dec_.initStream(stream_, nir_cnt_);
 }
 
+void Nir14Decompressor::reset()
+{
+    Nir14Base::reset();
+    nir_dec_.reset();
+    nir_dec_.getInStream().clear();
+}
+
 char *Nir14Decompressor::decompress(char *buf, int& sc)
 {
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc);
         stream_.getBytes((unsigned char*)buf, sizeof(las::nir14));
         c.last_.unpack(buf);
         c.have_last_ = true;
@@ -138,7 +158,7 @@ char *Nir14Decompressor::decompress(char *buf, int& sc)
         return buf + sizeof(las::nir14);
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     las::nir14 *pLastNir = &chan_ctxs_[last_channel_].last_;
     if (sc != last_channel_)
     {
@@ -46,9 +46,24 @@ protected:
         ChannelCtx() : have_last_{false}, used_model_(4),
             diff_model_{ models::arithmetic(256), models::arithmetic(256) }
         {}
+
+        void reset()
+        {
+            have_last_ = false;
+            last_ = las::nir14();
+            used_model_.reset();
+            for (auto& m : diff_model_)
+                m.reset();
+        }
     };
 
-    std::array<ChannelCtx, 4> chan_ctxs_;
+    void reset()
+    {
+        chan_ctxs_.forEach([](ChannelCtx& c){ c.reset(); });
+        last_channel_ = -1;
+    }
+
+    utils::lazy_array<ChannelCtx, 4> chan_ctxs_;
     int last_channel_ = -1;
 };
 
@@ -61,6 +76,7 @@ public:
     void writeSizes();
     void writeData();
     const char *compress(const char *buf, int& sc);
+    void reset();
 
 private:
     OutCbStream& stream_;
@@ -70,17 +86,20 @@ private:
 class Nir14Decompressor : public Nir14Base
 {
 public:
-    Nir14Decompressor(InCbStream& stream) : stream_(stream)
+    Nir14Decompressor(InCbStream& stream, uint32_t layers) : stream_(stream),
+        decode_(layers & layer::Nir)
     {}
 
     void dumpSums();
     void readSizes();
     void readData();
     char *decompress(char *buf, int& sc);
+    void reset();
 
 private:
     InCbStream& stream_;
     uint32_t nir_cnt_;
+    bool decode_;
     decoders::arithmetic<MemoryStream> nir_dec_;
     utils::Summer sumNir;
 };
@@ -150,6 +150,27 @@ Point10Base::~Point10Base()
     }
 }
 
+// Return to the state of a new object without freeing the models.
+void Point10Base::reset()
+{
+    last_intensity.fill(0);
+    for (auto& m : last_x_diff_median5)
+        m.init();
+    for (auto& m : last_y_diff_median5)
+        m.init();
+    last_height.fill(0);
+
+    m_changed_values.reset();
+    m_scan_angle_rank[0]->reset();
+    m_scan_angle_rank[1]->reset();
+    for (int i = 0; i < 256; i ++) {
+        m_bit_byte[i]->reset();
+        m_classification[i]->reset();
+        m_user_data[i]->reset();
+    }
+    have_last_ = false;
+}
+
 // COMPRESSOR
 
 Point10Compressor::Point10Compressor(encoders::arithmetic<OutCbStream>& enc) : enc_(enc),
@@ -166,6 +187,16 @@ void Point10Compressor::init()
     ic_z.init();
 }
 
+void Point10Compressor::reset()
+{
+    Point10Base::reset();
+    ic_intensity.reset();
+    ic_point_source_ID.reset();
+    ic_dx.reset();
+    ic_dy.reset();
+    ic_z.reset();
+}
+
 const char *Point10Compressor::compress(const char *buf)
 {
     las::point10 this_val(buf);
@@ -279,6 +310,16 @@ void Point10Decompressor::init()
     ic_z.init();
 }
 
+void Point10Decompressor::reset()
+{
+    Point10Base::reset();
+    ic_intensity.reset();
+    ic_point_source_ID.reset();
+    ic_dx.reset();
+    ic_dy.reset();
+    ic_z.reset();
+}
+
 char *Point10Decompressor::decompress(char *buf)
 {
     if (!decompressors_inited_)
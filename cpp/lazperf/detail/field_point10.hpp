@@ -42,6 +42,8 @@ protected:
     Point10Base();
     ~Point10Base();
 
+    void reset();
+
     las::point10 last_;
     std::array<unsigned short, 16> last_intensity;
 
@@ -65,6 +67,7 @@ public:
     Point10Compressor(encoders::arithmetic<OutCbStream>&);
 
     const char *compress(const char *buf);
+    void reset();
 
 private:
     void init();
@@ -84,6 +87,7 @@ public:
     Point10Decompressor(decoders::arithmetic<InCbStream>&);
 
     char *decompress(char *buf);
+    void reset();
 
 private:
     void init();
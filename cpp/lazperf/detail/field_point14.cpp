@@ -82,16 +82,69 @@ namespace {
 } // unnamed namespace
 
 Point14Base::Point14Base() : last_channel_(-1)
+{}
+
+// Return the context to its initial state without reallocating its models.
+void Point14Base::ChannelCtx::reset()
 {
-    //ABELL - For debug.
-    chan_ctxs_[0].ctx_num_ = 0;
-    chan_ctxs_[1].ctx_num_ = 1;
-    chan_ctxs_[2].ctx_num_ = 2;
-    chan_ctxs_[3].ctx_num_ = 3;
+    for (auto& m : changed_values_model_)
+        m.reset();
+    scanner_channel_model_.reset();
+    rn_gps_same_model_.reset();
+    for (auto& m : nr_model_)
+        m.reset();
+    for (auto& m : rn_model_)
+        m.reset();
+    for (auto& m : class_model_)
+        m.reset();
+    for (auto& m : flag_model_)
+        m.reset();
+    for (auto& m : user_data_model_)
+        m.reset();
+    gpstime_multi_model_.reset();
+    gpstime_0diff_model_.reset();
+
+    have_last_ = false;
+    last_intensity_.fill(0);
+    last_z_.fill(0);
+    for (auto& xd : last_x_diff_median5_)
+        xd.init();
+    for (auto& yd : last_y_diff_median5_)
+        yd.init();
+    last_gps_seq_ = 0;
+    next_gps_seq_ = 0;
+    last_gpstime_.fill(0);
+    last_gpstime_diff_.fill(0);
+    multi_extreme_counter_.fill(0);
+    gps_time_change_ = false;
 }
 
 // COMPRESSOR
 
+void Point14Compressor::ChannelCtx::reset()
+{
+    Point14Base::ChannelCtx::reset();
+    dx_compr_.reset();
+    dy_compr_.reset();
+    z_compr_.reset();
+    intensity_compr_.reset();
+    scan_angle_compr_.reset();
+    point_source_id_compr_.reset();
+    gpstime_compr_.reset();
+}
+
+void Point14Compressor::reset()
+{
+    chan_ctxs_.forEach([](ChannelCtx& c){ c.reset(); });
+    last_channel_ = -1;
+    for (auto enc : { &xy_enc_, &z_enc_, &class_enc_, &flags_enc_, &intensity_enc_,
+            &scan_angle_enc_, &user_data_enc_, &point_source_id_enc_, &gpstime_enc_ })
+    {
+        enc->reset();
+        enc->getOutStream().clear();
+    }
+}
+
 void Point14Compressor::writeSizes()
 {
     xy_enc_.done();
@@ -170,7 +223,7 @@ const char *Point14Compressor::compress(const char *buf, int& scArg)
     // last stuff and move on
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc);
         stream_.putBytes((const unsigned char*)buf, sizeof(las::point14));
         c.last_ = point;
         c.have_last_ = true;
@@ -199,7 +252,7 @@ const char *Point14Compressor::compress(const char *buf, int& scArg)
         (prev.gps_time_change_ << 2);                                   // bit 2
 
     // c is the context for this point.
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     // old is the same as c unless we've switched channels and don't have a previous
     // for this channel, in which case we use the last channel's context.
     // In other words, we prefer the last point in the same channel as this point
@@ -552,6 +605,31 @@ void Point14Decompressor::dumpSums()
     std::cout << "GPS time : " << sumGpsTime.value() << "\n";
 }
 
+void Point14Decompressor::ChannelCtx::reset()
+{
+    Point14Base::ChannelCtx::reset();
+    dx_decomp_.reset();
+    dy_decomp_.reset();
+    z_decomp_.reset();
+    intensity_decomp_.reset();
+    scan_angle_decomp_.reset();
+    point_source_id_decomp_.reset();
+    gpstime_decomp_.reset();
+}
+
+void Point14Decompressor::reset()
+{
+    chan_ctxs_.forEach([](ChannelCtx& c){ c.reset(); });
+    last_channel_ = -1;
+    for (auto dec : { &xy_dec_, &z_dec_, &class_dec_, &flags_dec_, &intensity_dec_,
+            &scan_angle_dec_, &user_data_dec_, &point_source_id_dec_, &gpstime_dec_ })
+    {
+        dec->reset();
+        dec->getInStream().clear();
+    }
+    sizes_.clear();
+}
+
 void Point14Decompressor::readSizes()
 {
     uint32_t xy_cnt;
@@ -587,19 +665,26 @@ void Point14Decompressor::readSizes()
 
 void Point14Decompressor::readData()
 {
-    auto cnt = sizes_.begin();
-
-    // Copy data and read the init bytes.
-    xy_dec_.initStream(stream_, *cnt++);
-    z_dec_.initStream(stream_, *cnt++);
-    class_dec_.initStream(stream_, *cnt++);
-    flags_dec_.initStream(stream_, *cnt++);
-    intensity_dec_.initStream(stream_, *cnt++);
-    scan_angle_dec_.initStream(stream_, *cnt++);
-    user_data_dec_.initStream(stream_, *cnt++);
-    point_source_id_dec_.initStream(stream_, *cnt++);
-    gpstime_dec_.initStream(stream_, *cnt++);
-    sizes_.clear();
+    decoders::arithmetic<MemoryStream> *decoders[] = { &xy_dec_, &z_dec_, &class_dec_,
+        &flags_dec_, &intensity_dec_, &scan_angle_dec_, &user_data_dec_,
+        &point_source_id_dec_, &gpstime_dec_ };
+    // XY is always decoded.
+    const uint32_t selectable[] = { 0, layer::Z, layer::Classification,
+        layer::Flags, layer::Intensity, layer::ScanAngle, layer::UserData,
+        layer::PointSourceId, layer::GpsTime };
+
+    // Copy data and read the init bytes. The data of the layers that aren't wanted is
+    // skipped. A layer without data is left unchanged from the first point, just as
+    // when it holds no changes.
+    for (size_t i = XyLayer; i <= GpsTimeLayer; ++i)
+    {
+        if (selectable[i] && !(layers_ & selectable[i]))
+        {
+            stream_.skipBytes(sizes_[i]);
+            sizes_[i] = 0;
+        }
+        decoders[i]->initStream(stream_, sizes_[i]);
+    }
 }
 
 char *Point14Decompressor::decompress(char *buf, int& scArg)
@@ -613,7 +698,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
         las::point14 point(buf);
 
         scArg = point.scannerChannel();
-        ChannelCtx& c = chan_ctxs_[scArg];
+        ChannelCtx& c = chan_ctxs_.get(scArg);
         c.last_ = point;
         c.have_last_ = true;
         c.last_gpstime_[0] = point.gpsTime();
@@ -659,7 +744,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
         scArg = sc;
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     if (!c.have_last_)
     {
         c.have_last_ = true;
@@ -714,6 +799,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
     }
 
     // Z
+    if (sizes_[ZLayer])
     {
         uint32_t kbits = (c.dx_decomp_.getK() + c.dy_decomp_.getK()) / 2;
         kbits = (std::min)(kbits, 18U) & ~1;
@@ -725,6 +811,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
     }
 
     // Classification
+    if (sizes_[ClassLayer])
     {
         int32_t ctx = ((r == 1 && r >= n) | ((c.last_.classification() & 0x1F) << 1));
         c.last_.setClassification(class_dec_.decodeSymbol(c.class_model_[ctx]));
@@ -732,6 +819,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
     }
 
     // Flags
+    if (sizes_[FlagsLayer])
     {
         uint32_t last_flags = c.last_.classFlags() |
             (c.last_.scanDirFlag() << 4) |
@@ -745,6 +833,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
     }
 
     // Intensity
+    if (sizes_[IntensityLayer])
     {
         int32_t ctx = gps_time_changed | ((r >= n) << 1) | ((r == 1) << 2);
 
@@ -757,7 +846,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
 
     // Scan angle
     {
-        if (scan_angle_changed)
+        if (scan_angle_changed && sizes_[ScanAngleLayer])
         {
             c.last_.setScanAngle(c.scan_angle_decomp_.decompress(scan_angle_dec_,
                         c.last_.scanAngle(), gps_time_changed));
@@ -766,6 +855,7 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
     }
 
     // User data
+    if (sizes_[UserDataLayer])
     {
         int32_t ctx = c.last_.userData() / 4;
         c.last_.setUserData(user_data_dec_.decodeSymbol(c.user_data_model_[ctx]));
@@ -774,13 +864,13 @@ char *Point14Decompressor::decompress(char *buf, int& scArg)
 
     // Point source ID
     {
-        if (point_source_changed)
+        if (point_source_changed && sizes_[PointSourceIdLayer])
             c.last_.setPointSourceID(c.point_source_id_decomp_.decompress(
                         point_source_id_dec_, c.last_.pointSourceID(), 0));
         LAZDEBUG(sumPointSourceId.add(c.last_.pointSourceID()));
     }
 
-    if (gps_time_changed)
+    if (gps_time_changed && sizes_[GpsTimeLayer])
         decodeGpsTime(c);
     LAZDEBUG(sumGpsTime.add(c.last_.gpsTime()));
     c.gps_time_change_ = gps_time_changed;
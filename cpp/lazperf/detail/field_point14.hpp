@@ -38,9 +38,11 @@ class Point14Base
 protected:
     Point14Base();
 
+    // The state and models common to encoding and decoding a scanner channel. The
+    // integer coders, which hold most of the models, are added by the compressor
+    // and the decompressor so that neither allocates the other's.
     struct ChannelCtx
     {
-        int ctx_num_;  //ABELL - For debug.
         std::vector<models::arithmetic> changed_values_model_;
         models::arithmetic scanner_channel_model_;
         models::arithmetic rn_gps_same_model_;
@@ -53,22 +55,6 @@ protected:
         models::arithmetic gpstime_multi_model_;
         models::arithmetic gpstime_0diff_model_;
 
-        compressors::integer dx_compr_;
-        compressors::integer dy_compr_;
-        compressors::integer z_compr_;
-        compressors::integer intensity_compr_;
-        compressors::integer scan_angle_compr_;
-        compressors::integer point_source_id_compr_;
-        compressors::integer gpstime_compr_;
-
-        decompressors::integer dx_decomp_;
-        decompressors::integer dy_decomp_;
-        decompressors::integer z_decomp_;
-        decompressors::integer intensity_decomp_;
-        decompressors::integer scan_angle_decomp_;
-        decompressors::integer point_source_id_decomp_;
-        decompressors::integer gpstime_decomp_;
-
         bool have_last_;
         las::point14 last_;
         std::array<uint16_t, 8> last_intensity_;
@@ -88,40 +74,19 @@ protected:
             class_model_(64, models::arithmetic(256)), flag_model_(64, models::arithmetic(64)), 
             user_data_model_(64, models::arithmetic(256)), gpstime_multi_model_(515),
             gpstime_0diff_model_(5),
-            dx_compr_(32, 2), dy_compr_(32, 22), z_compr_(32, 20), intensity_compr_(16, 4),
-            scan_angle_compr_(16, 2), point_source_id_compr_(16), gpstime_compr_(32, 9),
-            dx_decomp_(32, 2), dy_decomp_(32, 22), z_decomp_(32, 20), intensity_decomp_(16, 4),
-            scan_angle_decomp_(16, 2), point_source_id_decomp_(16), gpstime_decomp_(32, 9),
             have_last_{false}, last_gps_seq_{0}, next_gps_seq_{0},
             last_gpstime_{}, last_gpstime_diff_{}, multi_extreme_counter_{},
             gps_time_change_{}
         {
-            //ABELL - Move the init into the ctor, I think.
-            // Also, the encoder should be passed to the ctor.
-            dx_compr_.init();
-            dy_compr_.init();
-            z_compr_.init();
-            intensity_compr_.init();
-            scan_angle_compr_.init();
-            point_source_id_compr_.init();
-            gpstime_compr_.init(); 
-
-            dx_decomp_.init();
-            dy_decomp_.init();
-            z_decomp_.init();
-            intensity_decomp_.init();
-            scan_angle_decomp_.init();
-            point_source_id_decomp_.init();
-            gpstime_decomp_.init(); 
-
             for (auto& xd : last_x_diff_median5_)
                 xd.init();
             for (auto& yd : last_y_diff_median5_)
                 yd.init();
         }
+
+        void reset();
     };  // ChannelCtx
 
-    std::array<ChannelCtx, 4> chan_ctxs_;
     int last_channel_;
 };
 
@@ -134,10 +99,38 @@ public:
     void writeSizes();
     void writeData();
     const char *compress(const char *buf, int& sc);
+    void reset();
 
 private:
+    struct ChannelCtx : public Point14Base::ChannelCtx
+    {
+        compressors::integer dx_compr_;
+        compressors::integer dy_compr_;
+        compressors::integer z_compr_;
+        compressors::integer intensity_compr_;
+        compressors::integer scan_angle_compr_;
+        compressors::integer point_source_id_compr_;
+        compressors::integer gpstime_compr_;
+
+        ChannelCtx() : dx_compr_(32, 2), dy_compr_(32, 22), z_compr_(32, 20),
+            intensity_compr_(16, 4), scan_angle_compr_(16, 2), point_source_id_compr_(16),
+            gpstime_compr_(32, 9)
+        {
+            dx_compr_.init();
+            dy_compr_.init();
+            z_compr_.init();
+            intensity_compr_.init();
+            scan_angle_compr_.init();
+            point_source_id_compr_.init();
+            gpstime_compr_.init();
+        }
+
+        void reset();
+    };
+
     void encodeGpsTime(const las::point14& point, ChannelCtx& c);
 
+    utils::lazy_array<ChannelCtx, 4> chan_ctxs_;
     OutCbStream& stream_;
     encoders::arithmetic<MemoryStream> xy_enc_ = true;
     encoders::arithmetic<MemoryStream> z_enc_ = true;
@@ -153,18 +146,62 @@ private:
 class Point14Decompressor : public Point14Base
 {
 public:
-    Point14Decompressor(InCbStream& stream) : stream_(stream)
+    Point14Decompressor(InCbStream& stream, uint32_t layers) : stream_(stream),
+        layers_(layers)
     {}
    
     void dumpSums();
     void readSizes();
     void readData();
     char *decompress(char *buf, int& sc);
+    void reset();
 
 private:
+    struct ChannelCtx : public Point14Base::ChannelCtx
+    {
+        decompressors::integer dx_decomp_;
+        decompressors::integer dy_decomp_;
+        decompressors::integer z_decomp_;
+        decompressors::integer intensity_decomp_;
+        decompressors::integer scan_angle_decomp_;
+        decompressors::integer point_source_id_decomp_;
+        decompressors::integer gpstime_decomp_;
+
+        ChannelCtx() : dx_decomp_(32, 2), dy_decomp_(32, 22), z_decomp_(32, 20),
+            intensity_decomp_(16, 4), scan_angle_decomp_(16, 2), point_source_id_decomp_(16),
+            gpstime_decomp_(32, 9)
+        {
+            dx_decomp_.init();
+            dy_decomp_.init();
+            z_decomp_.init();
+            intensity_decomp_.init();
+            scan_angle_decomp_.init();
+            point_source_id_decomp_.init();
+            gpstime_decomp_.init();
+        }
+
+        void reset();
+    };
+
     void decodeGpsTime(ChannelCtx& c);
 
-    InCbStream stream_;
+    // Indexes into sizes_.
+    enum
+    {
+        XyLayer,
+        ZLayer,
+        ClassLayer,
+        FlagsLayer,
+        IntensityLayer,
+        ScanAngleLayer,
+        UserDataLayer,
+        PointSourceIdLayer,
+        GpsTimeLayer
+    };
+
+    utils::lazy_array<ChannelCtx, 4> chan_ctxs_;
+    InCbStream& stream_;
+    uint32_t layers_;
     decoders::arithmetic<MemoryStream> xy_dec_;
     decoders::arithmetic<MemoryStream> z_dec_;
     decoders::arithmetic<MemoryStream> class_dec_;
@@ -63,6 +63,19 @@ Rgb10Base::Rgb10Base() : have_last_(false), last(), m_byte_used(128), m_rgb_diff
     m_rgb_diff_5(256)
 {}
 
+void Rgb10Base::reset()
+{
+    have_last_ = false;
+    last = las::rgb();
+    m_byte_used.reset();
+    m_rgb_diff_0.reset();
+    m_rgb_diff_1.reset();
+    m_rgb_diff_2.reset();
+    m_rgb_diff_3.reset();
+    m_rgb_diff_4.reset();
+    m_rgb_diff_5.reset();
+}
+
 // COMPRESSOR
 
 Rgb10Compressor::Rgb10Compressor(encoders::arithmetic<OutCbStream>& encoder) : enc_(encoder)
@@ -33,6 +33,8 @@ class Rgb10Base
 protected:
     Rgb10Base();
 
+    void reset();
+
     bool have_last_;
     las::rgb last;
 
@@ -51,6 +53,7 @@ public:
     Rgb10Compressor(encoders::arithmetic<OutCbStream>&);
 
     const char *compress(const char *buf);
+    using Rgb10Base::reset;
 
 private:
     encoders::arithmetic<OutCbStream>& enc_;
@@ -62,6 +65,7 @@ public:
     Rgb10Decompressor(decoders::arithmetic<InCbStream>&);
 
     char *decompress(char *buf);
+    using Rgb10Base::reset;
 
 private:
     decoders::arithmetic<InCbStream>& dec_;
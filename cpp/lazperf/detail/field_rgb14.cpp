@@ -80,6 +80,13 @@ void Rgb14Compressor::writeData()
         stream_.putBytes(rgb_enc_.encoded_bytes(), rgb_enc_.num_encoded());
 }
 
+void Rgb14Compressor::reset()
+{
+    Rgb14Base::reset();
+    rgb_enc_.reset();
+    rgb_enc_.getOutStream().clear();
+}
+
 const char *Rgb14Compressor::compress(const char *buf, int& sc)
 {
     const las::rgb14 color(buf);
@@ -88,7 +95,7 @@ const char *Rgb14Compressor::compress(const char *buf, int& sc)
     // have last stuff and move on
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc);
         stream_.putBytes((const unsigned char*)&color, sizeof(las::rgb));
         c.last_ = color;
         c.have_last_ = true;
@@ -96,7 +103,7 @@ const char *Rgb14Compressor::compress(const char *buf, int& sc)
         return buf + sizeof(las::rgb);
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     las::rgb14 *pLastColor = &chan_ctxs_[last_channel_].last_;
     if (!c.have_last_)
     {
@@ -182,14 +189,27 @@ void Rgb14Decompressor::readSizes()
 
 void Rgb14Decompressor::readData()
 {
+    // Skipped data is treated as unchanged.
+    if (!decode_)
+    {
+        stream_.skipBytes(rgb_cnt_);
+        rgb_cnt_ = 0;
+    }
     rgb_dec_.initStream(stream_, rgb_cnt_);
 }
 
+void Rgb14Decompressor::reset()
+{
+    Rgb14Base::reset();
+    rgb_dec_.reset();
+    rgb_dec_.getInStream().clear();
+}
+
 char *Rgb14Decompressor::decompress(char *buf, int& sc)
 {
     if (last_channel_ == -1)
     {
-        ChannelCtx& c = chan_ctxs_[sc];
+        ChannelCtx& c = chan_ctxs_.get(sc);
         stream_.getBytes((unsigned char*)buf, sizeof(las::rgb));
         c.last_.unpack(buf);
         c.have_last_ = true;
@@ -203,7 +223,7 @@ char *Rgb14Decompressor::decompress(char *buf, int& sc)
         return buf + sizeof(las::rgb14);
     }
 
-    ChannelCtx& c = chan_ctxs_[sc];
+    ChannelCtx& c = chan_ctxs_.get(sc);
     las::rgb14 *pLastColor = &chan_ctxs_[last_channel_].last_;
     if (sc != last_channel_)
     {
@@ -48,9 +48,24 @@ protected:
                 models::arithmetic(256), models::arithmetic(256),
                 models::arithmetic(256), models::arithmetic(256) }
         {}
+
+        void reset()
+        {
+            have_last_ = false;
+            last_ = las::rgb14();
+            used_model_.reset();
+            for (auto& m : diff_model_)
+                m.reset();
+        }
     };
 
-    std::array<ChannelCtx, 4> chan_ctxs_;
+    void reset()
+    {
+        chan_ctxs_.forEach([](ChannelCtx& c){ c.reset(); });
+        last_channel_ = -1;
+    }
+
+    utils::lazy_array<ChannelCtx, 4> chan_ctxs_;
     int last_channel_ = -1;
 };
 
@@ -63,6 +78,7 @@ public:
     void writeSizes();
     void writeData();
     const char *compress(const char *buf, int& sc);
+    void reset();
 
 private:
     OutCbStream& stream_;
@@ -72,17 +88,20 @@ private:
 class Rgb14Decompressor : public Rgb14Base
 {
 public:
-    Rgb14Decompressor(InCbStream& stream) : stream_(stream)
+    Rgb14Decompressor(InCbStream& stream, uint32_t layers) : stream_(stream),
+        decode_(layers & layer::Rgb)
     {}
 
     void dumpSums();
     void readSizes();
     void readData();
     char *decompress(char *buf, int& sc);
+    void reset();
 
 private:
     InCbStream& stream_;
     uint32_t rgb_cnt_;
+    bool decode_;
     decoders::arithmetic<MemoryStream> rgb_dec_;
     utils::Summer sumRgb;
 };
@@ -129,6 +129,16 @@ public:
     void makeValid()
     { valid = true; }
 
+    // Restart encoding. A stream the encoder owns must be cleared by the caller.
+    void reset()
+    {
+        valid = initial_valid;
+        base   = 0;
+        length = AC__MaxLength;
+        outbyte = outbuffer;
+        endbyte = endbuffer;
+    }
+
     void done()
     {
         uint32_t init_base = base;                 // done encoding: set final data bytes
@@ -329,7 +339,7 @@ public:
 private:
     void init(bool v)
     {
-        valid = v;
+        valid = initial_valid = v;
         outbuffer = new uint8_t[2*AC_BUFFER_SIZE];
         endbuffer = outbuffer + 2 * AC_BUFFER_SIZE;
 
@@ -342,6 +352,7 @@ private:
     void init(const arithmetic<TOutStream>& src)
     {
         valid = src.valid;
+        initial_valid = src.initial_valid;
         outbuffer = new uint8_t[2*AC_BUFFER_SIZE];
         endbuffer = outbuffer + 2 * AC_BUFFER_SIZE;
 
@@ -407,6 +418,7 @@ private:
     uint8_t* endbyte;
     uint32_t base, value, length;
     bool valid;
+    bool initial_valid;
 
     std::unique_ptr<TOutStream> pOut;
     TOutStream& outstream;
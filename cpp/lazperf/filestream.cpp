@@ -1,3 +1,11 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "filestream.hpp"
 #include "excepts.hpp"
 
@@ -21,93 +29,330 @@ OutputCb OutFileStream::cb()
     return std::bind(&OutFileStream::putBytes, this, _1, _2);
 }
 
-// InFileStream
+// OutAsyncStream
 
-struct InFileStream::Private
+struct OutAsyncStream::Private
 {
-    // Setting the offset_ to the buffer size will force a fill on the first read.
-    Private(std::istream& in) : f_(in)
-    { reset(); }
-
-    void getBytes(unsigned char *buf, size_t request);
-    size_t fillit();
-    void reset()
+    Private(std::ostream& out, size_t bufsize, size_t depth) : f_(out), bufsize_(bufsize),
+        depth_(depth), writing_(false), done_(false), failed_(false)
     {
-        buf_.resize(1 << 20);
-        offset_ = buf_.size();
+        buf_.reserve(bufsize_);
+        thread_ = std::thread(&Private::run, this);
     }
 
-    std::istream& f_;
-    std::vector<unsigned char> buf_;
-    size_t offset_;
+    void putBytes(const unsigned char *c, size_t len);
+    void handOff();
+    void flush();
+    void run();
+    void check();
+
+    std::ostream& f_;
+    std::vector<unsigned char> buf_; // the buffer being filled
+    size_t bufsize_;
+    size_t depth_;
+    std::deque<std::vector<unsigned char>> full_; // buffers waiting to be written
+    std::vector<std::vector<unsigned char>> spare_; // written buffers for reuse
+    bool writing_;
+    bool done_;
+    std::atomic<bool> failed_;
+    std::exception_ptr error_; // the failure of a write on the I/O thread
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
 };
 
-InFileStream::InFileStream(std::istream& in) : p_(new Private(in))
+OutAsyncStream::OutAsyncStream(std::ostream& out, size_t bufsize, size_t depth) :
+    p_(new Private(out, bufsize, (std::max)(depth, (size_t)1)))
 {}
 
-InFileStream::~InFileStream()
-{}
+// A write error can't be thrown from here. Call flush() first to see it.
+OutAsyncStream::~OutAsyncStream()
+{
+    try
+    {
+        p_->flush();
+    }
+    catch (...)
+    {}
+    {
+        std::lock_guard<std::mutex> lock(p_->mutex_);
+        p_->done_ = true;
+    }
+    p_->cv_.notify_all();
+    p_->thread_.join();
+}
 
-// This will force a fill on the next fetch.
-void InFileStream::reset()
+void OutAsyncStream::putBytes(const unsigned char *c, size_t len)
 {
-    p_->reset();
+    p_->putBytes(c, len);
 }
 
-InputCb InFileStream::cb()
+OutputCb OutAsyncStream::cb()
 {
     using namespace std::placeholders;
 
-    return std::bind(&InFileStream::Private::getBytes, p_.get(), _1, _2);
+    return std::bind(&OutAsyncStream::Private::putBytes, p_.get(), _1, _2);
+}
+
+void OutAsyncStream::flush()
+{
+    p_->flush();
 }
 
-void InFileStream::Private::getBytes(unsigned char *buf, size_t request)
+void OutAsyncStream::Private::putBytes(const unsigned char *c, size_t len)
 {
-    // Almost all requests are size 1.
-    if (request == 1)
+    if (failed_)
+        check();
+    buf_.insert(buf_.end(), c, c + len);
+    if (buf_.size() >= bufsize_)
+        handOff();
+}
+
+// Queue the current buffer for writing and start another, waiting if the queue is full.
+void OutAsyncStream::Private::handOff()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]{ return full_.size() < depth_ || error_; });
+    if (error_)
+        std::rethrow_exception(error_);
+    full_.push_back(std::move(buf_));
+    if (spare_.size())
+    {
+        buf_ = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    else
     {
-        if (offset_ >= buf_.size())
-            fillit();
-        *buf = buf_[offset_++];
-        return;
+        buf_ = std::vector<unsigned char>();
+        buf_.reserve(bufsize_);
     }
+    lock.unlock();
+    cv_.notify_all();
+}
 
-    size_t available = buf_.size() - offset_;
-    if (request <= available)
+void OutAsyncStream::Private::flush()
+{
+    if (buf_.size())
+        handOff();
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]{ return full_.empty() && !writing_; });
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+// Rethrow the failure of a write on the I/O thread.
+void OutAsyncStream::Private::check()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void OutAsyncStream::Private::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock, [this]{ return full_.size() || done_; });
+        if (full_.empty())
+            break;
+
+        std::vector<unsigned char> buf(std::move(full_.front()));
+        full_.pop_front();
+        writing_ = true;
+        lock.unlock();
+        cv_.notify_all();
+
+        // Keep the failure for the writer and drop anything still queued.
+        std::exception_ptr err;
+        try
+        {
+            f_.write(reinterpret_cast<const char *>(buf.data()), buf.size());
+            if (!f_)
+                throw error("Couldn't write to the output stream.");
+        }
+        catch (...)
+        {
+            err = std::current_exception();
+        }
+        buf.clear();
+
+        lock.lock();
+        writing_ = false;
+        spare_.push_back(std::move(buf));
+        if (err && !error_)
+        {
+            error_ = err;
+            failed_ = true;
+            full_.clear();
+        }
+        cv_.notify_all();
+    }
+}
+
+// InWindowStream
+
+InWindowStream::~InWindowStream()
+{}
+
+InputCb InWindowStream::cb()
+{
+    using namespace std::placeholders;
+
+    return std::bind(&InWindowStream::getBytes, this, _1, _2);
+}
+
+void InWindowStream::getBytes(unsigned char *buf, size_t request)
+{
+    while (true)
+    {
+        size_t bytes = (std::min)(request, (size_t)(end_ - pos_));
+        std::copy(pos_, pos_ + bytes, buf);
+        pos_ += bytes;
+        request -= bytes;
+        if (request == 0)
+            break;
+        buf += bytes;
+        refill();
+    }
+}
+
+void InWindowStream::skipBytes(size_t count)
+{
+    skip(count);
+}
+
+void InWindowStream::skip(size_t request)
+{
+    while (true)
     {
-        unsigned char *begin = buf_.data() + offset_;
-        unsigned char *end = begin + request;
-        std::copy(begin, end, buf);
-        offset_ += request;
+        size_t bytes = (std::min)(request, (size_t)(end_ - pos_));
+        pos_ += bytes;
+        request -= bytes;
+        if (request == 0)
+            break;
+        refill();
     }
+}
+
+// InFileStream
+
+struct InFileStream::Private
+{
+    Private(std::istream& in) : f_(in)
+    {}
+
+    std::istream& f_;
+    std::vector<unsigned char> buf_;
+};
+
+// An empty window will force a fill on the first read.
+InFileStream::InFileStream(std::istream& in) : p_(new Private(in))
+{}
+
+InFileStream::~InFileStream()
+{}
+
+// This will force a fill on the next fetch.
+void InFileStream::reset()
+{
+    pos_ = end_;
+}
+
+// Skip past anything that isn't buffered with a seek.
+void InFileStream::skip(size_t request)
+{
+    size_t available = end_ - pos_;
+    if (request <= available)
+        pos_ += request;
     else
     {
-        do
-        {
-            size_t bytes = (std::min)(request, available);
-            unsigned char *begin = buf_.data() + offset_;
-            unsigned char *end = begin + bytes;
-            std::copy(begin, end, buf);
-            offset_ += bytes;
-            request -= bytes;
-            if (request == 0)
-                break;
-            buf += bytes;
-            available = fillit();
-        } while (true);
+        p_->f_.clear();
+        p_->f_.seekg(request - available, std::ios::cur);
+        reset();
     }
 }
 
-size_t InFileStream::Private::fillit()
+void InFileStream::refill()
 {
-    offset_ = 0;
-    f_.read(reinterpret_cast<char *>(buf_.data()), buf_.size());
-    size_t filled = f_.gcount();
+    std::vector<unsigned char>& buf = p_->buf_;
 
+    buf.resize(1 << 20);
+    p_->f_.read(reinterpret_cast<char *>(buf.data()), buf.size());
+    size_t filled = p_->f_.gcount();
     if (filled == 0)
         throw error("Unexpected end of file.");
-    buf_.resize(filled);
-    return filled;
+    pos_ = buf.data();
+    end_ = pos_ + filled;
+}
+
+// InMemStream
+
+InMemStream::InMemStream(const char *buf, size_t count) :
+    begin_(reinterpret_cast<const unsigned char *>(buf))
+{
+    pos_ = begin_;
+    end_ = begin_ + count;
+}
+
+void InMemStream::seek(uint64_t pos)
+{
+    pos_ = begin_ + (std::min)(pos, (uint64_t)(end_ - begin_));
+}
+
+// The memory is all there is.
+void InMemStream::refill()
+{
+    throw error("Unexpected end of file.");
+}
+
+// OutMemStream
+
+OutMemStream::OutMemStream() : buf_(nullptr), capacity_(0), pos_(0), size_(0),
+    growable_(true)
+{}
+
+OutMemStream::OutMemStream(char *buf, size_t capacity) : buf_(buf), capacity_(capacity),
+    pos_(0), size_(0), growable_(false)
+{}
+
+void OutMemStream::putBytes(const unsigned char *c, size_t len)
+{
+    if (len > capacity_ - pos_)
+    {
+        if (!growable_)
+            throw error("Output buffer is full.");
+        grown_.resize((std::max)(pos_ + len, 2 * capacity_));
+        buf_ = grown_.data();
+        capacity_ = grown_.size();
+    }
+    std::copy(c, c + len, buf_ + pos_);
+    pos_ += len;
+    size_ = (std::max)(size_, pos_);
+}
+
+OutputCb OutMemStream::cb()
+{
+    using namespace std::placeholders;
+
+    return std::bind(&OutMemStream::putBytes, this, _1, _2);
+}
+
+void OutMemStream::seek(uint64_t pos)
+{
+    if (pos > size_)
+        throw error("Can't seek past the end of the output.");
+    pos_ = (size_t)pos;
+}
+
+const char *OutMemStream::data() const
+{
+    return buf_;
+}
+
+size_t OutMemStream::size() const
+{
+    return size_;
 }
 
 } // namespace lazperf
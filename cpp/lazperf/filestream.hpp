@@ -29,8 +29,10 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
 
 #include "lazperf.hpp"
+#include "excepts.hpp"
 
 namespace lazperf
 {
@@ -51,7 +53,63 @@ private:
 
 // Convenience class
 
-struct InFileStream
+// Collects output in large buffers that a separate thread writes to the stream, so
+// that the caller doesn't wait on the output. At most 'depth' full buffers wait to be
+// written before putBytes() blocks. The stream must not be used by anyone else until
+// flush() returns. A failed write is thrown from the next call to putBytes() or flush(),
+// and nothing more is written.
+struct OutAsyncStream
+{
+    struct Private;
+
+public:
+    LAZPERF_EXPORT OutAsyncStream(std::ostream& out, size_t bufsize = 1 << 20,
+        size_t depth = 2);
+    // Writes anything left, ignoring any error.
+    LAZPERF_EXPORT ~OutAsyncStream();
+
+    LAZPERF_EXPORT void putBytes(const unsigned char *c, size_t len);
+    LAZPERF_EXPORT OutputCb cb();
+    // Wait until everything passed to putBytes() has been written.
+    LAZPERF_EXPORT void flush();
+
+private:
+    std::unique_ptr<Private> p_;
+};
+
+// Base for input that is read from a window of contiguous bytes by moving a
+// pointer. The window is refilled a block at a time when it runs out, so fetching
+// a byte only costs a call once per block.
+struct InWindowStream
+{
+public:
+    InWindowStream() : pos_(nullptr), end_(nullptr)
+    {}
+    LAZPERF_EXPORT virtual ~InWindowStream();
+
+    LAZPERF_EXPORT InputCb cb();
+    LAZPERF_EXPORT void getBytes(unsigned char *buf, size_t request);
+    LAZPERF_EXPORT void skipBytes(size_t count);
+
+    unsigned char getByte()
+    {
+        if (pos_ == end_)
+            refill();
+        return *pos_++;
+    }
+
+protected:
+    // Make more bytes available at pos_ or throw.
+    LAZPERF_EXPORT virtual void refill() = 0;
+    LAZPERF_EXPORT virtual void skip(size_t count);
+
+    const unsigned char *pos_;
+    const unsigned char *end_;
+};
+
+// Convenience class
+
+struct InFileStream : public InWindowStream
 {
     struct Private;
 
@@ -61,11 +119,60 @@ public:
 
     // This will force a fill on the next fetch.
     LAZPERF_EXPORT void reset();
-    LAZPERF_EXPORT InputCb cb();
+
+protected:
+    LAZPERF_EXPORT virtual void refill();
+    LAZPERF_EXPORT virtual void skip(size_t count);
 
 private:
     std::unique_ptr<Private> p_;
 };
 
+// Convenience class
+
+// Reads from a block of memory (such as a mapped file) in place, without the
+// intermediate buffer of InFileStream. The memory must outlive the stream.
+struct InMemStream : public InWindowStream
+{
+public:
+    LAZPERF_EXPORT InMemStream(const char *buf, size_t count);
+
+    // Position the next fetch 'pos' bytes from the start of the memory.
+    LAZPERF_EXPORT void seek(uint64_t pos);
+
+protected:
+    LAZPERF_EXPORT virtual void refill();
+
+private:
+    const unsigned char *begin_;
+};
+
+// Convenience class
+
+// Writes to memory: a buffer that grows as needed or a block supplied by the caller
+// (such as a mapped file). Writing past the end of a supplied block throws.
+struct OutMemStream
+{
+public:
+    LAZPERF_EXPORT OutMemStream();
+    LAZPERF_EXPORT OutMemStream(char *buf, size_t capacity);
+
+    LAZPERF_EXPORT void putBytes(const unsigned char *c, size_t len);
+    LAZPERF_EXPORT OutputCb cb();
+    // Position the next write 'pos' bytes from the start of the memory.
+    LAZPERF_EXPORT void seek(uint64_t pos);
+    // The data written and its size, which is the furthest position written.
+    LAZPERF_EXPORT const char *data() const;
+    LAZPERF_EXPORT size_t size() const;
+
+private:
+    std::vector<char> grown_;
+    char *buf_;
+    size_t capacity_;
+    size_t pos_;
+    size_t size_;
+    bool growable_;
+};
+
 } // namespace lazperf
 
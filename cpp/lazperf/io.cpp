@@ -28,6 +28,17 @@
 ===============================================================================
 */
 
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "io.hpp"
 #include "io_private.hpp"
 
@@ -61,6 +72,218 @@ int baseCount(int format)
     }
 }
 
+// Where a dimension is found in a point record.
+struct field
+{
+    enum kind
+    {
+        Missing,
+        Uint8,
+        Int8,
+        Uint16,
+        Int16,
+        Int32,
+        Double
+    };
+
+    kind k;
+    int offset;
+    int shift;
+    int mask;   // 0 for the whole value
+};
+
+field findField(int format, reader::column::dimension dim)
+{
+    using dimension = reader::column::dimension;
+
+    format &= 0xF;
+    bool legacy = (format <= 3);
+    bool hasGps = (format == 1 || format == 3 || format >= 6);
+    int rgbOffset = (format == 2 ? 20 : format == 3 ? 28 : format >= 7 ? 30 : 0);
+
+    switch (dim)
+    {
+    case dimension::X:
+        return { field::Int32, 0, 0, 0 };
+    case dimension::Y:
+        return { field::Int32, 4, 0, 0 };
+    case dimension::Z:
+        return { field::Int32, 8, 0, 0 };
+    case dimension::Intensity:
+        return { field::Uint16, 12, 0, 0 };
+    case dimension::ReturnNumber:
+        return legacy ? field{ field::Uint8, 14, 0, 0x7 } : field{ field::Uint8, 14, 0, 0xF };
+    case dimension::NumberOfReturns:
+        return legacy ? field{ field::Uint8, 14, 3, 0x7 } : field{ field::Uint8, 14, 4, 0xF };
+    case dimension::ScanDirectionFlag:
+        return { field::Uint8, legacy ? 14 : 15, 6, 0x1 };
+    case dimension::EdgeOfFlightLine:
+        return { field::Uint8, legacy ? 14 : 15, 7, 0x1 };
+    case dimension::Classification:
+        return legacy ? field{ field::Uint8, 15, 0, 0x1F } : field{ field::Uint8, 16, 0, 0 };
+    case dimension::ClassFlags:
+        return legacy ? field{ field::Uint8, 15, 5, 0x7 } : field{ field::Uint8, 15, 0, 0xF };
+    case dimension::ScannerChannel:
+        return legacy ? field{ field::Missing, 0, 0, 0 } : field{ field::Uint8, 15, 4, 0x3 };
+    case dimension::ScanAngle:
+        return legacy ? field{ field::Int8, 16, 0, 0 } : field{ field::Int16, 18, 0, 0 };
+    case dimension::UserData:
+        return { field::Uint8, 17, 0, 0 };
+    case dimension::PointSourceId:
+        return { field::Uint16, legacy ? 18 : 20, 0, 0 };
+    case dimension::GpsTime:
+        if (!hasGps)
+            break;
+        return { field::Double, legacy ? 20 : 22, 0, 0 };
+    case dimension::Red:
+    case dimension::Green:
+    case dimension::Blue:
+        if (!rgbOffset)
+            break;
+        return { field::Uint16, rgbOffset + 2 * (dim - dimension::Red), 0, 0 };
+    case dimension::Nir:
+        if (format != 8)
+            break;
+        return { field::Uint16, 36, 0, 0 };
+    }
+    return { field::Missing, 0, 0, 0 };
+}
+
+// Whether every value of a field of kind 'k' can be stored in 'type'. Integers
+// can't go to an unsigned or narrower integer type, but any field can be read as
+// Double and any integer as Float.
+bool converts(field::kind k, reader::column::value_type type)
+{
+    using value_type = reader::column::value_type;
+
+    if (type == value_type::Double)
+        return true;
+    if (type == value_type::Float)
+        return k != field::Double;
+    switch (k)
+    {
+    case field::Uint8:
+        return type != value_type::Int8;
+    case field::Int8:
+        return type == value_type::Int8 || type == value_type::Int16 ||
+            type == value_type::Int32 || type == value_type::Int64;
+    case field::Uint16:
+        return type != value_type::Int8 && type != value_type::Uint8 &&
+            type != value_type::Int16;
+    case field::Int16:
+        return type == value_type::Int16 || type == value_type::Int32 ||
+            type == value_type::Int64;
+    case field::Int32:
+        return type == value_type::Int32 || type == value_type::Int64;
+    default:
+        return false;
+    }
+}
+
+// The value of a field of type S in the point record at 'p'.
+template <typename S>
+S fieldValue(const char *p, const field& f)
+{
+    S v;
+    memcpy(&v, p + f.offset, sizeof(S));
+    return f.mask ? static_cast<S>((v >> f.shift) & f.mask) : v;
+}
+
+template <>
+double fieldValue<double>(const char *p, const field& f)
+{
+    double v;
+    memcpy(&v, p + f.offset, sizeof(double));
+    return v;
+}
+
+// Copy a field of type S out of 'n' point records into values of type D, 'stride'
+// bytes apart. converts() has checked that every value fits.
+template <typename S, typename D>
+void copyField(const char *in, size_t pointLen, size_t n, const field& f,
+    char *out, size_t stride)
+{
+    for (size_t i = 0; i < n; ++i, in += pointLen, out += stride)
+    {
+        D v = static_cast<D>(fieldValue<S>(in, f));
+        memcpy(out, &v, sizeof(D));
+    }
+}
+
+// Copy scaled and offset X, Y or Z values.
+template <typename D>
+void copyScaled(const char *in, size_t pointLen, size_t n, const field& f,
+    char *out, size_t stride, double scale, double offset)
+{
+    for (size_t i = 0; i < n; ++i, in += pointLen, out += stride)
+    {
+        D v = static_cast<D>(fieldValue<int32_t>(in, f) * scale + offset);
+        memcpy(out, &v, sizeof(D));
+    }
+}
+
+template <typename S>
+void copyField(const char *in, size_t pointLen, size_t n, const field& f,
+    reader::column::value_type type, char *out, size_t stride)
+{
+    using value_type = reader::column::value_type;
+
+    switch (type)
+    {
+    case value_type::Int8:
+        copyField<S, int8_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Uint8:
+        copyField<S, uint8_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Int16:
+        copyField<S, int16_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Uint16:
+        copyField<S, uint16_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Int32:
+        copyField<S, int32_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Uint32:
+        copyField<S, uint32_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Int64:
+        copyField<S, int64_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Uint64:
+        copyField<S, uint64_t>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Float:
+        copyField<S, float>(in, pointLen, n, f, out, stride);
+        break;
+    case value_type::Double:
+        copyField<S, double>(in, pointLen, n, f, out, stride);
+        break;
+    }
+}
+
+size_t typeSize(reader::column::value_type type)
+{
+    using value_type = reader::column::value_type;
+
+    switch (type)
+    {
+    case value_type::Int8:
+    case value_type::Uint8:
+        return 1;
+    case value_type::Int16:
+    case value_type::Uint16:
+        return 2;
+    case value_type::Int32:
+    case value_type::Uint32:
+    case value_type::Float:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
 } // unnamed namespace
 
 int io::header::ebCount() const
@@ -77,25 +300,354 @@ namespace reader
 void basic_file::Private::readPoint(char *out)
 {
     if (!compressed)
-        stream->cb()(reinterpret_cast<unsigned char *>(out), header.point_record_length);
+        dataCb()(reinterpret_cast<unsigned char *>(out), header.point_record_length);
+
+    // copy the next point out of the chunk decoded by the worker pool
+    else if (pool)
+    {
+        size_t offset = chunk_state.points_read * header.point_record_length;
+        if (offset >= chunk_points.size())
+        {
+            nextDecodedChunk();
+            offset = 0;
+        }
+        std::copy(chunk_points.data() + offset,
+            chunk_points.data() + offset + header.point_record_length, out);
+        chunk_state.points_read++;
+    }
 
     // read the next point in
     else
     {
-        if (chunk_state.points_read == laz.chunk_size || !pdecompressor)
+        if (!pdecompressor ||
+                (uint64_t)chunk_state.points_read == chunkPoints(chunk_state.current - 1))
+            nextChunk();
+
+        pdecompressor->decompress(out);
+        chunk_state.points_read++;
+    }
+}
+
+void basic_file::Private::readPoints(char *out, size_t count)
+{
+    const size_t pointLen = header.point_record_length;
+
+    if (!compressed)
+    {
+        dataCb()(reinterpret_cast<unsigned char *>(out), count * pointLen);
+        return;
+    }
+
+    // Work a chunk at a time so that the chunk checks happen once per chunk
+    // rather than once per point.
+    while (count)
+    {
+        size_t n;
+        if (pool)
+        {
+            size_t offset = chunk_state.points_read * pointLen;
+            if (offset >= chunk_points.size())
+            {
+                nextDecodedChunk();
+                offset = 0;
+            }
+            n = (std::min)(count, (chunk_points.size() - offset) / pointLen);
+            std::copy(chunk_points.data() + offset,
+                chunk_points.data() + offset + n * pointLen, out);
+            out += n * pointLen;
+        }
+        else
         {
-            pdecompressor = build_las_decompressor(stream->cb(), header.point_format_id,
-                header.ebCount());
-            // reset chunk state
-            chunk_state.current++;
-            chunk_state.points_read = 0;
+            if (!pdecompressor ||
+                    (uint64_t)chunk_state.points_read == chunkPoints(chunk_state.current - 1))
+                nextChunk();
+
+            n = (std::min)((uint64_t)count,
+                chunkPoints(chunk_state.current - 1) - chunk_state.points_read);
+            las_decompressor& decompressor = *pdecompressor;
+            for (size_t i = 0; i < n; ++i, out += pointLen)
+                decompressor.decompress(out);
         }
+        chunk_state.points_read += n;
+        count -= n;
+    }
+}
 
-        pdecompressor->decompress(out);
+// Points are decoded in small batches that stay in cache and then copied straight to
+// the columns, rather than decoding everything and transposing it afterwards.
+void basic_file::Private::readColumns(const std::vector<column>& columns, size_t count)
+{
+    using value_type = column::value_type;
+
+    std::vector<field> fields;
+    for (const column& c : columns)
+    {
+        fields.push_back(findField(header.point_format_id, c.dim));
+        if (fields.back().k == field::Missing)
+            throw error("Dimension " + std::to_string(c.dim) +
+                " isn't part of point format " + std::to_string(header.point_format_id) + ".");
+        if (!converts(fields.back().k, c.type))
+            throw error("Dimension " + std::to_string(c.dim) +
+                " can't be stored as value type " + std::to_string(c.type) + ".");
+    }
+
+    const size_t BatchSize = 1024;
+    const size_t pointLen = header.point_record_length;
+    std::vector<char> batch(BatchSize * pointLen);
+
+    for (size_t done = 0; done < count;)
+    {
+        size_t n = (std::min)(BatchSize, count - done);
+        readPoints(batch.data(), n);
+
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            const column& c = columns[i];
+            const field& f = fields[i];
+            const char *in = batch.data();
+            size_t stride = c.stride ? c.stride : typeSize(c.type);
+            char *out = static_cast<char *>(c.dest) + done * stride;
+
+            if ((c.type == value_type::Float || c.type == value_type::Double) &&
+                c.dim <= column::Z)
+            {
+                double scale = (c.dim == column::X) ? header.scale.x :
+                    (c.dim == column::Y) ? header.scale.y : header.scale.z;
+                double offset = (c.dim == column::X) ? header.offset.x :
+                    (c.dim == column::Y) ? header.offset.y : header.offset.z;
+                if (c.type == value_type::Float)
+                    copyScaled<float>(in, pointLen, n, f, out, stride, scale, offset);
+                else
+                    copyScaled<double>(in, pointLen, n, f, out, stride, scale, offset);
+                continue;
+            }
+
+            switch (f.k)
+            {
+            case field::Uint8:
+                copyField<uint8_t>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            case field::Int8:
+                copyField<int8_t>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            case field::Uint16:
+                copyField<uint16_t>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            case field::Int16:
+                copyField<int16_t>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            case field::Int32:
+                copyField<int32_t>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            default:
+                copyField<double>(in, pointLen, n, f, c.type, out, stride);
+                break;
+            }
+        }
+        done += n;
+    }
+}
+
+void basic_file::Private::nextChunk()
+{
+    // Jump over chunks the filter excludes.
+    uint64_t chunk = chunk_state.current;
+    if (chunk_selected.size())
+    {
+        while (chunk < chunk_selected.size() && !chunk_selected[chunk])
+            chunk++;
+        if (chunk == chunk_selected.size())
+            throw error("Attempt to read beyond the last chunk.");
+        if (chunk != (uint64_t)chunk_state.current)
+            seekData(chunk_table_offsets[chunk]);
+    }
+    // Variable-sized chunks end with the chunk table.
+    if (variableChunks() && chunkPoints(chunk) == 0)
+        throw error("Attempt to read beyond the last chunk.");
+
+    resetDecompressor();
+    // reset chunk state
+    chunk_state.current = chunk + 1;
+    chunk_state.points_read = 0;
+}
+
+void basic_file::Private::nextDecodedChunk()
+{
+    queueChunks();
+    if (decoded_chunks.empty())
+        throw error("Attempt to read beyond the last chunk.");
+
+    chunk_points = decoded_chunks.front().second.get();
+    chunk_state.current = decoded_chunks.front().first + 1;
+    decoded_chunks.pop_front();
+    chunk_state.points_read = 0;
+
+    // Replace the chunk we just took.
+    queueChunks();
+}
+
+// Read the raw data for upcoming chunks and hand it to the worker pool to decode.
+// Each chunk is independent, so each task gets its own decompressor.
+void basic_file::Private::queueChunks()
+{
+    const uint64_t numChunks = chunk_table_offsets.size() - 1;
+    const int format = header.point_format_id;
+    const size_t ebCount = header.ebCount();
+    const size_t pointLen = header.point_record_length;
+    const uint32_t layers = this->layers;
+
+    while (decoded_chunks.size() < 2 * pool->size() && next_chunk < numChunks)
+    {
+        uint64_t chunk = next_chunk++;
+        if (!chunkSelected(chunk))
+            continue;
+        size_t count = (size_t)chunkPoints(chunk);
+        if (count == 0)
+            break;
+
+        // Memory is decoded in place. Otherwise the chunk is copied so that the tasks
+        // never touch the source.
+        uint64_t offset = chunk_table_offsets[chunk];
+        size_t size = chunk_table_offsets[chunk + 1] - offset;
+        std::shared_ptr<InMemStream> in;
+        std::shared_ptr<std::vector<char>> buf;
+        if (mem_data)
+            in.reset(new InMemStream(mem_data + offset, size));
+        else
+        {
+            buf.reset(new std::vector<char>(size));
+            readData(offset, buf->data(), size);
+            in.reset(new InMemStream(buf->data(), size));
+        }
+
+        decoded_chunks.emplace_back(chunk, pool->add<std::vector<char>>(
+            [in, buf, format, ebCount, layers, pointLen, count]()
+            {
+                las_decompressor::ptr decompressor =
+                    build_las_decompressor(*in, format, ebCount, layers);
+                std::vector<char> points(count * pointLen);
+                for (size_t i = 0; i < count; ++i)
+                    decompressor->decompress(points.data() + i * pointLen);
+                return points;
+            }
+        ));
+    }
+}
+
+void basic_file::Private::setThreads(unsigned count)
+{
+    // Note where we are so that reading can continue from there in the new mode.
+    bool started = compressed && (pdecompressor || !chunk_points.empty());
+    uint64_t pos = started ?
+        chunkFirstPoint(chunk_state.current - 1) + chunk_state.points_read : 0;
+
+    threads = count;
+    pool.reset(compressed && threads > 1 ? new ThreadPool(threads) : nullptr);
+    pdecompressor.reset();
+    decoded_chunks.clear();
+    chunk_points.clear();
+    next_chunk = 0;
+    chunk_state = ChunkState();
+
+    if (started && pos < pointCount())
+        seek(pos);
+}
+
+void basic_file::Private::setLayers(uint32_t l)
+{
+    layers = l;
+    // Rebuild the decoding state at the current point.
+    setThreads(threads);
+}
+
+void basic_file::Private::seek(uint64_t pointIndex)
+{
+    if (pointIndex >= pointCount())
+        throw error("Can't seek to point " + std::to_string(pointIndex) +
+            ". Index is beyond the last point.");
+
+    if (!compressed)
+    {
+        seekData(header.point_offset + pointIndex * header.point_record_length);
+        return;
+    }
+
+    // Jump to the start of the chunk that holds the point.
+    uint64_t chunk = std::upper_bound(chunk_table_points.begin(), chunk_table_points.end(),
+        pointIndex) - chunk_table_points.begin() - 1;
+    if (chunk + 1 >= chunk_table_points.size())
+        throw error("Can't seek to point " + std::to_string(pointIndex) +
+            ". Chunk table is missing the containing chunk.");
+
+    // A chunk the filter excludes is passed over for the next one that isn't.
+    if (!chunkSelected(chunk))
+    {
+        while (chunk < chunk_selected.size() && !chunk_selected[chunk])
+            chunk++;
+        if (chunk == chunk_selected.size())
+        {
+            restart();
+            chunk_state.current = chunk;
+            next_chunk = chunk;
+            return;
+        }
+        pointIndex = chunk_table_points[chunk];
+    }
+
+    if (pool)
+    {
+        decoded_chunks.clear();
+        next_chunk = chunk;
+        chunk_state.current = chunk;
+        nextDecodedChunk();
+        chunk_state.points_read = pointIndex - chunk_table_points[chunk];
+        return;
+    }
+
+    seekData(chunk_table_offsets[chunk]);
+
+    resetDecompressor();
+    chunk_state.current = chunk + 1;
+    chunk_state.points_read = 0;
+
+    // Decode and discard the points in the chunk that precede the one requested.
+    std::vector<char> skip(header.point_record_length);
+    for (uint64_t i = chunk_table_points[chunk]; i < pointIndex; ++i)
+    {
+        pdecompressor->decompress(skip.data());
         chunk_state.points_read++;
     }
 }
 
+uint64_t basic_file::Private::pointCount() const
+{
+    if (header.version.major > 1 || header.version.minor > 3)
+        return header14.point_count_14;
+    return header.point_count;
+}
+
+// Number of points in a (zero-based) chunk. Fixed-size chunks past the end of a
+// short chunk table are assumed to be full.
+uint64_t basic_file::Private::chunkPoints(uint64_t chunk) const
+{
+    if (chunk + 1 < chunk_table_points.size())
+        return chunk_table_points[chunk + 1] - chunk_table_points[chunk];
+    return variableChunks() ? 0 : laz.chunk_size;
+}
+
+// Index of the first point in a (zero-based) chunk.
+uint64_t basic_file::Private::chunkFirstPoint(uint64_t chunk) const
+{
+    if (chunk < chunk_table_points.size())
+        return chunk_table_points[chunk];
+    return chunk_table_points.back() + (chunk + 1 - chunk_table_points.size()) * laz.chunk_size;
+}
+
+bool basic_file::Private::variableChunks() const
+{
+    return laz.chunk_size == (std::numeric_limits<unsigned int>::max)();
+}
+
 void basic_file::Private::loadHeader()
 {
     // Make sure our header is correct
@@ -125,17 +677,106 @@ void basic_file::Private::loadHeader()
     if (compressed)
     {
         validateHeader();
-        parseChunkTable();
+        // Layered (1.4) chunks can be found without the chunk table, so a missing,
+        // damaged or incomplete table isn't fatal.
+        bool complete = false;
+        try
+        {
+            parseChunkTable();
+            complete = (chunk_table_points.back() == pointCount());
+        }
+        catch (const error&)
+        {
+            if (laz.compressor != 3)
+                throw;
+        }
+        if (!complete && laz.compressor == 3)
+            scanChunkTable();
+        parseEVLRs();
     }
 
     // set the file pointer to the beginning of data to start reading
-    // may have treaded past the EOL, so reset everything before we start reading
-    f->clear();
     uint64_t offset = header.point_offset;
     if (compressed)
         offset += sizeof(int64_t);
-    f->seekg(offset);
-    stream->reset();
+    seekData(offset);
+}
+
+void basic_file::Private::open(const char *buf, size_t count)
+{
+    mem_data = buf;
+    mem_stream.reset(new InMemStream(buf, count));
+    // The headers and chunk table are parsed through a stream over the same memory.
+    // Nothing is written through it.
+    mem_buf.reset(new charbuf(const_cast<char *>(buf), count));
+    mem_f.reset(new std::istream(mem_buf.get()));
+    f = mem_f.get();
+    loadHeader();
+}
+
+void basic_file::Private::close()
+{
+    // Worker threads may be decoding from the source.
+    decoded_chunks.clear();
+    pool.reset();
+    pdecompressor.reset();
+}
+
+// Callback that supplies point data from the current position.
+InputCb basic_file::Private::dataCb()
+{
+    return mem_stream ? mem_stream->cb() : stream->cb();
+}
+
+// Prepare to decode the chunk at the current position. An existing decompressor reads
+// from the same source, so it's reset in place rather than rebuilt.
+void basic_file::Private::resetDecompressor()
+{
+    if (pdecompressor)
+        pdecompressor->reset();
+    else
+        pdecompressor = dataDecompressor();
+}
+
+// Decompressor for the chunk at the current position. Memory is read in place and
+// files through the stream's buffer.
+las_decompressor::ptr basic_file::Private::dataDecompressor()
+{
+    if (mem_stream)
+        return build_las_decompressor(*mem_stream, header.point_format_id,
+            header.ebCount(), layers);
+    return build_las_decompressor(*stream, header.point_format_id,
+        header.ebCount(), layers);
+}
+
+void basic_file::Private::seekData(uint64_t pos)
+{
+    if (mem_stream)
+        mem_stream->seek(pos);
+    else
+    {
+        // may have treaded past the EOF, so reset everything before we start reading
+        f->clear();
+        f->seekg(pos);
+        stream->reset();
+    }
+}
+
+void basic_file::Private::readData(uint64_t pos, char *buf, size_t count)
+{
+    if (mem_stream)
+    {
+        mem_stream->seek(pos);
+        mem_stream->getBytes(reinterpret_cast<unsigned char *>(buf), count);
+        return;
+    }
+
+    f->clear();
+    f->seekg(pos);
+    f->read(buf, count);
+    if (!f->good())
+        throw error("Unable to read " + std::to_string(count) + " bytes at offset " +
+            std::to_string(pos) + ".");
 }
 
 void basic_file::Private::fixMinMax()
@@ -196,7 +837,8 @@ void basic_file::Private::parseVLRs()
 void basic_file::Private::parseLASZIPVLR(const char *buf)
 {
     laz.fill(buf);
-    if (laz.compressor != 2)
+    // 2 is pointwise chunked (PDRF 0-3), 3 is layered chunked (PDRF 6-8).
+    if (laz.compressor != 2 && laz.compressor != 3)
         throw error("LASZIP format unsupported - invalid compressor version.");
 }
 
@@ -210,8 +852,15 @@ void basic_file::Private::parseChunkTable()
     if (!f->good())
         throw error("Couldn't read chunk table.");
 
+    // Writers that can't seek back to fill in the offset put it in the last 8 bytes
+    // of the file instead.
     if (chunkoffset == -1)
-        throw error("Chunk table offset == -1 is not supported at this time");
+    {
+        f->seekg(-(std::streamoff)sizeof(chunkoffset), std::ios::end);
+        f->read((char*)&chunkoffset, sizeof(chunkoffset));
+        if (!f->good() || chunkoffset == -1)
+            throw error("Couldn't read chunk table offset from the end of the file.");
+    }
 
     // Go to the chunk offset and read in the table
     f->seekg(chunkoffset);
@@ -234,42 +883,245 @@ void basic_file::Private::parseChunkTable()
     if (chunk_table_header.version != 0)
         throw error("Bad chunk table. Invalid version.");
 
-    // start pushing in chunk table offsets
-    chunk_table_offsets.clear();
+    // Variable-sized chunks have their point counts stored in the table.
+    bool variable = variableChunks();
 
-    if (laz.chunk_size == (std::numeric_limits<unsigned int>::max)())
-        throw error("Chunk size too large - unsupported.");
+    // Every chunk holds at least one point.
+    size_t chunk_count = chunk_table_header.chunk_count;
+    if (chunk_count > pointCount())
+        throw error("Bad chunk table. Invalid chunk count.");
 
     // Allocate enough room for our chunk
-    chunk_table_offsets.resize(chunk_table_header.chunk_count + 1);
+    chunk_table_offsets.assign(chunk_count + 1, 0);
+    chunk_table_points.assign(chunk_count + 1, 0);
 
     // Add The first one
     chunk_table_offsets[0] = header.point_offset + sizeof(uint64_t);
 
-    //ABELL - Use the standard call for this.
-    if (chunk_table_header.chunk_count > 1)
+    if (chunk_count > 1)
     {
         // decode the index out
         InFileStream fstream(*f);
+        std::vector<chunk> chunks = decompress_chunk_table(fstream.cb(), chunk_count, variable);
+
+        for (size_t i = 1; i <= chunk_count; i++)
+        {
+            const chunk& c = chunks[i - 1];
+            chunk_table_offsets[i] = chunk_table_offsets[i - 1] + c.size;
+            chunk_table_points[i] = chunk_table_points[i - 1] +
+                (variable ? c.count : laz.chunk_size);
+            // The last fixed-size chunk may be short.
+            if (!variable)
+                chunk_table_points[i] = (std::min)(chunk_table_points[i], pointCount());
+        }
+    }
+    // A single chunk ends where the chunk table begins.
+    else if (chunk_count == 1)
+    {
+        chunk_table_offsets[1] = chunkoffset;
+        chunk_table_points[1] = pointCount();
+    }
+
+    // The chunks all precede the table.
+    for (size_t i = 1; i < chunk_table_offsets.size(); ++i)
+        if (chunk_table_offsets[i] < chunk_table_offsets[i - 1] ||
+                chunk_table_offsets[i] > (uint64_t)chunkoffset)
+            throw error("Bad chunk table. Invalid chunk offsets.");
+}
+
+// Rebuild the chunk table by walking the chunks of a layered (PDRF 6-8) file. Each
+// chunk starts with its first point stored raw, then the point count and the byte
+// count of each layer, so the next chunk can be found without decoding anything.
+// Scanning stops at the first incomplete chunk, so a truncated file yields the
+// chunks that are intact.
+void basic_file::Private::scanChunkTable()
+{
+    if (laz.compressor != 3)
+        throw error("Can't rebuild the chunk table. The file doesn't use layered chunks.");
+
+    // Raw size of the first point and the number of layer sizes that follow the count.
+    const int format = header.point_format_id;
+    const size_t ebCount = header.ebCount();
+    size_t rawSize = baseCount(format) + ebCount;
+    size_t layers = 9 + ebCount;   // Nine point14 layers and one per extra byte.
+    if (format == 7 || format == 8)
+        layers++;   // RGB
+    if (format == 8)
+        layers++;   // NIR
+
+    f->clear();
+    f->seekg(0, std::ios::end);
+    const uint64_t end = f->tellg();
+
+    chunk_table_offsets.assign(1, header.point_offset + sizeof(uint64_t));
+    chunk_table_points.assign(1, 0);
+
+    std::vector<uint32_t> sizes(1 + layers);
+    while (chunk_table_points.back() < pointCount())
+    {
+        uint64_t pos = chunk_table_offsets.back() + rawSize;
+        if (pos + sizes.size() * sizeof(uint32_t) > end)
+            break;
+
+        f->seekg(pos);
+        f->read(reinterpret_cast<char *>(sizes.data()), sizes.size() * sizeof(uint32_t));
+        if (!f->good())
+            break;
+
+        uint32_t count = le32toh(sizes[0]);
+        pos += sizes.size() * sizeof(uint32_t);
+        for (size_t i = 1; i < sizes.size(); ++i)
+            pos += le32toh(sizes[i]);
+        if (count == 0 || pos > end)
+            break;
+
+        chunk_table_offsets.push_back(pos);
+        chunk_table_points.push_back(
+            (std::min)(chunk_table_points.back() + count, pointCount()));
+    }
+}
+
+void basic_file::Private::rebuildChunkTable()
+{
+    if (!compressed)
+        return;
+
+    scanChunkTable();
+    // Statistics are no use if they don't match the chunks.
+    if (stats.chunks.size() != chunk_table_offsets.size() - 1)
+    {
+        stats.chunks.clear();
+        chunk_selected.clear();
+    }
+    restart();
+}
 
-        InCbStream stream(fstream.cb());
-        decoders::arithmetic<InCbStream> decoder(stream);
-        decompressors::integer decomp(32, 2);
+// Start reading again from the first point.
+void basic_file::Private::restart()
+{
+    pdecompressor.reset();
+    decoded_chunks.clear();
+    chunk_points.clear();
+    next_chunk = 0;
+    chunk_state = ChunkState();
+    seekData(chunk_table_offsets[0]);
+}
 
-        // start decoder
-        decoder.readInitBytes();
-        decomp.init();
+// Find the chunk statistics EVLR, if there is one.
+void basic_file::Private::parseEVLRs()
+{
+    if (header.version.minor < 4 || header14.elvr_count == 0)
+        return;
 
-        for (size_t i = 1 ; i <= chunk_table_header.chunk_count; i++)
+    uint64_t pos = header14.evlr_offset;
+    for (uint32_t i = 0; i < header14.elvr_count; ++i)
+    {
+        vlr::evlr_header h;
+        f->clear();
+        f->seekg(pos);
+        f->read(reinterpret_cast<char *>(&h), sizeof(h));
+        if (!f->good())
+            return;
+        if (chunk_stats_vlr::matches(h))
         {
-            uint32_t offset = i > 1 ? (int32_t)chunk_table_offsets[i - 1] : 0;
-            chunk_table_offsets[i] = static_cast<uint64_t>(
-                decomp.decompress(decoder, offset, 1));
+            std::vector<char> buf(h.record_length_after_header);
+            f->read(buf.data(), buf.size());
+            if (f->good())
+                stats.fill(buf.data(), buf.size());
+            // Statistics for some other set of chunks are no use.
+            if (stats.chunks.size() != chunk_table_offsets.size() - 1)
+                stats.chunks.clear();
+            return;
         }
+        pos += sizeof(h) + h.record_length_after_header;
+    }
+}
+
+bool basic_file::Private::setFilter(const filter& flt)
+{
+    chunk_selected.clear();
+    if (stats.chunks.size())
+    {
+        bool hasGps = findField(header.point_format_id,
+            column::GpsTime).k != field::Missing;
+        const double fmin[3] = { flt.minimum.x, flt.minimum.y, flt.minimum.z };
+        const double fmax[3] = { flt.maximum.x, flt.maximum.y, flt.maximum.z };
 
-        for (size_t i = 1 ; i < chunk_table_offsets.size() ; i ++)
-            chunk_table_offsets[i] += chunk_table_offsets[i - 1];
+        for (const chunk_stats_vlr::stats& s : stats.chunks)
+        {
+            bool selected = true;
+            for (int d = 0; d < 3; ++d)
+                if (s.maximum[d] < fmin[d] || s.minimum[d] > fmax[d])
+                    selected = false;
+            if (hasGps && (s.max_gps_time < flt.min_gps_time ||
+                    s.min_gps_time > flt.max_gps_time))
+                selected = false;
+            if (flt.classes.size())
+            {
+                bool found = false;
+                for (uint8_t c : flt.classes)
+                    if (s.classes[c])
+                        found = true;
+                if (!found)
+                    selected = false;
+            }
+            chunk_selected.push_back(selected);
+        }
     }
+    if (compressed)
+        restart();
+    return !stats.chunks.empty();
+}
+
+bool basic_file::Private::chunkSelected(uint64_t chunk) const
+{
+    return chunk >= chunk_selected.size() || chunk_selected[chunk];
+}
+
+uint64_t basic_file::Private::filteredPointCount() const
+{
+    if (chunk_selected.empty())
+        return pointCount();
+
+    uint64_t count = 0;
+    for (uint64_t chunk = 0; chunk < chunk_selected.size(); ++chunk)
+        if (chunk_selected[chunk])
+            count += chunkPoints(chunk);
+    return count;
+}
+
+std::vector<chunk> basic_file::Private::chunkTable() const
+{
+    std::vector<chunk> chunks;
+    for (size_t i = 0; i + 1 < chunk_table_offsets.size(); ++i)
+        chunks.push_back({ (uint32_t)chunkPoints(i),
+            (uint32_t)(chunk_table_offsets[i + 1] - chunk_table_offsets[i]) });
+    return chunks;
+}
+
+void basic_file::Private::writeChunkTable(std::ostream& out)
+{
+    if (!compressed)
+        throw error("Can't write a chunk table for an uncompressed file.");
+
+    std::vector<chunk> chunks = chunkTable();
+
+    // Append the table and point the offset that precedes the point data at it.
+    out.seekp(0, std::ios::end);
+    int64_t offset = out.tellp();
+
+    uint32_t version = 0;
+    uint32_t count = (uint32_t)chunks.size();
+    out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    OutFileStream stream(out);
+    compress_chunk_table(stream.cb(), chunks, variableChunks());
+
+    out.seekp(header.point_offset);
+    out.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    out.flush();
+    if (!out.good())
+        throw error("Couldn't write chunk table.");
 }
 
 void basic_file::Private::validateHeader()
@@ -301,6 +1153,16 @@ void basic_file::open(std::istream& f)
     p_->loadHeader();
 }
 
+void basic_file::open(const char *buf, size_t count)
+{
+    p_->open(buf, count);
+}
+
+void basic_file::close()
+{
+    p_->close();
+}
+
 void basic_file::readPoint(char *out)
 {
     p_->readPoint(out);
@@ -311,52 +1173,223 @@ const io::header& basic_file::header() const
     return p_->header;
 }
 
-size_t basic_file::pointCount() const
+void basic_file::readPoints(char *out, size_t count)
 {
-    if (p_->header.version.major > 1 || p_->header.version.minor > 3)
-        return p_->header14.point_count_14;
-    return p_->header.point_count;
+    p_->readPoints(out, count);
 }
 
-// reader::mem_file
+bool basic_file::setFilter(const filter& f)
+{
+    return p_->setFilter(f);
+}
 
-mem_file::mem_file(char *buf, size_t count) : p_(new Private(buf, count))
+uint64_t basic_file::filteredPointCount() const
 {
-    open(p_->f);
+    return p_->filteredPointCount();
 }
 
-mem_file::~mem_file()
-{}
+void basic_file::readColumns(const std::vector<column>& columns, size_t count)
+{
+    p_->readColumns(columns, count);
+}
 
-// reader::generic_file
+void basic_file::seek(uint64_t pointIndex)
+{
+    p_->seek(pointIndex);
+}
 
-generic_file::generic_file(std::istream& in)
+void basic_file::setThreads(unsigned threads)
 {
-    open(in);
+    p_->setThreads(threads);
 }
 
-// reader::named_file
+void basic_file::setLayers(uint32_t layers)
+{
+    p_->setLayers(layers);
+}
 
-named_file::named_file(const std::string& filename) : p_(new Private(filename))
+void basic_file::rebuildChunkTable()
 {
-    open(p_->f);
+    p_->rebuildChunkTable();
 }
 
-named_file::~named_file()
-{}
+void basic_file::writeChunkTable(std::ostream& out)
+{
+    p_->writeChunkTable(out);
+}
 
-} // namespace reader
+std::vector<chunk> basic_file::chunks() const
+{
+    return p_->chunkTable();
+}
+
+const laz_vlr& basic_file::lazVlr() const
+{
+    return p_->laz;
+}
+
+const std::vector<chunk_stats_vlr::stats>& basic_file::chunkStats() const
+{
+    return p_->stats.chunks;
+}
+
+size_t basic_file::pointCount() const
+{
+    return p_->pointCount();
+}
+
+// reader::mem_file
+
+mem_file::mem_file(char *buf, size_t count)
+{
+    open(buf, count);
+}
+
+// reader::generic_file
+
+generic_file::generic_file(std::istream& in)
+{
+    open(in);
+}
+
+// reader::named_file
+
+named_file::named_file(const std::string& filename, access mode) : p_(new Private)
+{
+    if (mode == stream)
+    {
+        p_->f.open(filename, std::ios::binary);
+        open(p_->f);
+    }
+    else
+    {
+        p_->map(filename, mode);
+        open(p_->data, p_->size);
+    }
+}
+
+named_file::~named_file()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+void named_file::Private::map(const std::string& filename, named_file::access)
+{
+    // Windows has no equivalent of the access advice, so the mode only selects mapping.
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        throw error("Couldn't open '" + filename + "' for reading.");
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart)
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping)
+    {
+        data = (char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (size_t)fileSize.QuadPart;
+        CloseHandle(mapping);
+    }
+    // The view keeps the file open.
+    CloseHandle(file);
+    if (!data)
+        throw error("Couldn't map '" + filename + "'.");
+}
+
+named_file::Private::~Private()
+{
+    if (data)
+        UnmapViewOfFile(data);
+}
+
+#else
+
+void named_file::Private::map(const std::string& filename, named_file::access mode)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw error("Couldn't open '" + filename + "' for reading.");
+
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file open.
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        throw error("Couldn't map '" + filename + "'.");
+
+    data = (char *)addr;
+    size = (size_t)st.st_size;
+    madvise(addr, size, mode == map_random ? MADV_RANDOM : MADV_SEQUENTIAL);
+}
+
+named_file::Private::~Private()
+{
+    if (data)
+        munmap(data, size);
+}
+
+#endif
+
+} // namespace reader
 
 // WRITER
 
 namespace writer
 {
 
-void basic_file::Private::open(std::ostream& out, const io::header& h, uint32_t cs)
+void basic_file::Private::open(std::ostream& out, const io::header& h, uint32_t cs,
+    bool canSeek)
+{
+    f = &out;
+    stream.reset(new OutFileStream(out));
+    begin(h, cs, canSeek);
+}
+
+// The 1.4 counts of the caller's header are used if the output can't seek.
+void basic_file::Private::open(std::ostream& out, const io::header14& h, uint32_t cs,
+    bool canSeek)
+{
+    header14.point_count_14 = h.point_count_14;
+    std::copy(h.points_by_return_14, h.points_by_return_14 + 15,
+        header14.points_by_return_14);
+    open(out, static_cast<const io::header&>(h), cs, canSeek);
+}
+
+// Write to memory, which takes the place of the output stream.
+void basic_file::Private::open(OutMemStream *out, const io::header& h, uint32_t cs)
+{
+    mem_stream.reset(out);
+    begin(h, cs, true);
+}
+
+void basic_file::Private::begin(const io::header& h, uint32_t cs, bool canSeek)
 {
     header = h;
     chunk_size = cs;
-    f = &out;
+    seekable = canSeek;
+
+    // An output that can't seek gets the header now, along with a chunk table
+    // offset of -1 to say that the real offset follows the chunk table.
+    if (!seekable)
+    {
+        // writeHeader() rearranges the header for the file. Keep the working copy.
+        io::header14 working = header14;
+        writeHeader();
+        header14 = working;
+        if (compressed())
+        {
+            int64_t chunk_table_offset = -1;
+            putBytes(reinterpret_cast<const unsigned char *>(&chunk_table_offset),
+                sizeof(chunk_table_offset));
+        }
+        chunk_state.last_chunk_write_offset = chunk_state.write_offset;
+        return;
+    }
 
     size_t preludeSize = h.version.minor == 4 ? sizeof(io::header14) : sizeof(io::header);
     if (compressed())
@@ -371,10 +1404,157 @@ void basic_file::Private::open(std::ostream& out, const io::header& h, uint32_t
         preludeSize += vlr.size() + vlr.header().size();
     }
 
-    std::vector<char> junk(preludeSize);
-    f->write(junk.data(), preludeSize);
+    std::vector<unsigned char> junk(preludeSize);
+    putBytes(junk.data(), preludeSize);
     // the first chunk begins at the end of prelude
-    stream.reset(new OutFileStream(out));
+    chunk_state.last_chunk_write_offset = chunk_state.write_offset;
+}
+
+// Pick up where the compressed file in 'io' leaves off.
+void basic_file::Private::append(std::iostream& io)
+{
+    uint64_t count;
+    {
+        reader::generic_file r(io);
+        // Only a compressed file has the LASzip items.
+        if (r.lazVlr().items.empty())
+            throw error("Only compressed files can be appended to.");
+        if (r.header().version.minor == 4)
+            header14 = static_cast<const io::header14&>(r.header());
+        else
+            header = r.header();
+        chunk_size = r.lazVlr().chunk_size;
+        chunks = r.chunks();
+        stats.chunks = r.chunkStats();
+        keep_stats = stats.chunks.size();
+        count = r.pointCount();
+
+        if (header.version.minor == 4)
+            std::copy(header14.points_by_return_14, header14.points_by_return_14 + 15,
+                points_by_return);
+        else
+            std::copy(header.points_by_return, header.points_by_return + 5,
+                points_by_return);
+        if (count == 0)
+        {
+            header.minimum = { (std::numeric_limits<double>::max)(),
+                (std::numeric_limits<double>::max)(), (std::numeric_limits<double>::max)() };
+            header.maximum = { std::numeric_limits<double>::lowest(),
+                std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() };
+        }
+
+        // A short last chunk would end up in the middle of the file, where readers
+        // expect full chunks. Take its points out of the file to be written again.
+        if (chunk_size != io::VariableChunkSize && chunks.size() &&
+            chunks.back().count < chunk_size)
+        {
+            uint32_t tail = chunks.back().count;
+            tail_points.resize(tail * header.point_record_length);
+            r.seek(count - tail);
+            r.readPoints(tail_points.data(), tail);
+            chunks.pop_back();
+            if (stats.chunks.size())
+                stats.chunks.pop_back();
+
+            uint64_t fileReturns[15] = {};
+            std::swap(fileReturns, points_by_return);
+            countReturns(tail_points.data(), tail);
+            for (int i = 0; i < 15; ++i)
+                points_by_return[i] = fileReturns[i] - points_by_return[i];
+            count -= tail;
+        }
+    }
+
+    // The EVLRs follow the chunk table, where the new chunks go, so they're kept to be
+    // written again after the new table. Statistics are written anew.
+    if (header.version.minor == 4 && header14.elvr_count && header14.evlr_offset)
+    {
+        io.clear();
+        io.seekg(header14.evlr_offset);
+        for (uint32_t i = 0; i < header14.elvr_count; ++i)
+        {
+            vlr::evlr_header h;
+            io.read(reinterpret_cast<char *>(&h), sizeof(h));
+            std::vector<char> data(h.record_length_after_header);
+            io.read(data.data(), data.size());
+            if (!io.good())
+                throw error("Couldn't read the EVLRs of the file being appended to.");
+            if (chunk_stats_vlr::matches(h))
+                continue;
+            const char *hp = reinterpret_cast<const char *>(&h);
+            kept_evlrs.insert(kept_evlrs.end(), hp, hp + sizeof(h));
+            kept_evlrs.insert(kept_evlrs.end(), data.begin(), data.end());
+            kept_evlr_count++;
+        }
+    }
+    header14.evlr_offset = 0;
+    header14.elvr_count = 0;
+
+    f = &io;
+    stream.reset(new OutFileStream(io));
+    seekable = true;
+    appending = true;
+    existing_points = count;
+    chunk_state.total_written = count;
+
+    // New chunks start where the kept ones end.
+    uint64_t end = header.point_offset + sizeof(int64_t);
+    for (const chunk& c : chunks)
+        end += c.size;
+    io.clear();
+    seekOut(end);
+    chunk_state.last_chunk_write_offset = end;
+}
+
+// Whether points have been written since the file was opened.
+bool basic_file::Private::started() const
+{
+    return chunk_state.total_written != (int64_t)existing_points;
+}
+
+// Write the points taken from the end of a file being appended to.
+void basic_file::Private::writeTail()
+{
+    if (tail_points.empty())
+        return;
+
+    std::vector<char> points;
+    points.swap(tail_points);
+    writePoints(points.data(), points.size() / header.point_record_length);
+}
+
+// Write to the output, keeping track of the position without asking the stream,
+// which may not be able to tell.
+void basic_file::Private::putBytes(const unsigned char *b, size_t len)
+{
+    if (mem_stream)
+        mem_stream->putBytes(b, len);
+    else if (async_stream)
+        async_stream->putBytes(b, len);
+    else
+        stream->putBytes(b, len);
+    chunk_state.write_offset += len;
+}
+
+// Position the next write. Only for seekable outputs.
+void basic_file::Private::seekOut(uint64_t pos)
+{
+    if (mem_stream)
+        mem_stream->seek(pos);
+    else
+    {
+        if (async_stream)
+            async_stream->flush();
+        f->seekp(pos);
+    }
+    chunk_state.write_offset = pos;
+}
+
+OutputCb basic_file::Private::dataCb()
+{
+    using namespace std::placeholders;
+
+    return std::bind(&Private::putBytes, this, _1, _2);
 }
 
 bool basic_file::Private::compressed() const
@@ -382,65 +1562,333 @@ bool basic_file::Private::compressed() const
     return chunk_size > 0;
 }
 
-void basic_file::Private::updateMinMax(const las::point10& p)
+void basic_file::Private::updateMinMax(const char *p, size_t count)
+{
+    // Find the integer extent of the batch and only then scale it.
+    int32_t mins[3] = { (std::numeric_limits<int32_t>::max)(),
+        (std::numeric_limits<int32_t>::max)(), (std::numeric_limits<int32_t>::max)() };
+    int32_t maxs[3] = { std::numeric_limits<int32_t>::lowest(),
+        std::numeric_limits<int32_t>::lowest(), std::numeric_limits<int32_t>::lowest() };
+    for (size_t i = 0; i < count; ++i, p += header.point_record_length)
+    {
+        int32_t xyz[3];
+        memcpy(xyz, p, sizeof(xyz));
+        for (int d = 0; d < 3; ++d)
+        {
+            mins[d] = (std::min)(mins[d], xyz[d]);
+            maxs[d] = (std::max)(maxs[d], xyz[d]);
+        }
+    }
+    if (count == 0)
+        return;
+
+    const double scale[3] = { header.scale.x, header.scale.y, header.scale.z };
+    const double offset[3] = { header.offset.x, header.offset.y, header.offset.z };
+    double *minimum[3] = { &header.minimum.x, &header.minimum.y, &header.minimum.z };
+    double *maximum[3] = { &header.maximum.x, &header.maximum.y, &header.maximum.z };
+    for (int d = 0; d < 3; ++d)
+    {
+        double lo = mins[d] * scale[d] + offset[d];
+        double hi = maxs[d] * scale[d] + offset[d];
+        // A negative scale swaps the ends.
+        if (lo > hi)
+            std::swap(lo, hi);
+        *minimum[d] = (std::min)(lo, *minimum[d]);
+        *maximum[d] = (std::max)(hi, *maximum[d]);
+    }
+}
+
+void basic_file::Private::countReturns(const char *p, size_t count)
 {
-    double x = p.x * header.scale.x + header.offset.x;
-    double y = p.y * header.scale.y + header.offset.y;
-    double z = p.z * header.scale.z + header.offset.z;
+    const field f = findField(header.point_format_id, reader::column::ReturnNumber);
+    for (size_t i = 0; i < count; ++i, p += header.point_record_length)
+    {
+        int r = ((uint8_t)p[f.offset] >> f.shift) & f.mask;
+        // Return number 0 isn't valid and isn't counted.
+        if (r)
+            points_by_return[r - 1]++;
+    }
+}
 
-    header.minimum.x = (std::min)(x, header.minimum.x);
-    header.minimum.y = (std::min)(y, header.minimum.y);
-    header.minimum.z = (std::min)(z, header.minimum.z);
+void basic_file::Private::setThreads(unsigned count)
+{
+    if (started())
+        throw error("The number of threads must be set before writing points.");
 
-    header.maximum.x = (std::max)(x, header.maximum.x);
-    header.maximum.y = (std::max)(y, header.maximum.y);
-    header.maximum.z = (std::max)(z, header.maximum.z);
+    threads = count;
+    pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
 }
 
-void basic_file::Private::writePoint(const char *p)
+void basic_file::Private::setAsyncWrites(bool on)
 {
+    if (started())
+        throw error("Asynchronous writes must be set before writing points.");
+
+    if (on && f)
+    {
+        if (!async_stream)
+            async_stream.reset(new OutAsyncStream(*f));
+    }
+    else
+        async_stream.reset();
+}
+
+void basic_file::Private::writePoints(const char *p, size_t count)
+{
+    const size_t pointLen = header.point_record_length;
+
+    writeTail();
+    updateMinMax(p, count);
+    countReturns(p, count);
+    chunk_state.total_written += count;
     if (!compressed())
-        stream->putBytes(reinterpret_cast<const unsigned char *>(p), header.point_record_length);
+    {
+        putBytes(reinterpret_cast<const unsigned char *>(p), count * pointLen);
+        return;
+    }
+
+    // Split the batch where chunks end.
+    while (count)
+    {
+        if (chunk_state.points_in_chunk == 0)
+            chunk_state.chunk_limit = chunkLimit();
+        size_t n = (std::min)(count,
+            (size_t)(chunk_state.chunk_limit - chunk_state.points_in_chunk));
+        if (pool)
+            chunk_points.insert(chunk_points.end(), p, p + n * pointLen);
+        else
+        {
+            if (!pcompressor)
+                pcompressor = build_las_compressor(dataCb(), header.point_format_id,
+                    header.ebCount());
+            for (size_t i = 0; i < n; ++i)
+                pcompressor->compress(p + i * pointLen);
+        }
+        if (keep_stats)
+            addStats(p, n);
+        p += n * pointLen;
+        count -= n;
+        chunk_state.points_in_chunk += n;
+
+        if (chunk_state.points_in_chunk == chunk_state.chunk_limit)
+            endChunk();
+    }
+}
+
+// Finish the chunk being written, if it has any points.
+void basic_file::Private::endChunk()
+{
+    if (chunk_state.points_in_chunk == 0)
+        return;
+
+    if (keep_stats)
+    {
+        stats.chunks.push_back(chunk_stat);
+        chunk_stat = chunk_stats_vlr::stats();
+    }
+
+    if (pool)
+        queueChunk();
     else
     {
-        //ABELL - This first bit can go away if we simply always create compressor.
-        if (!pcompressor)
+        // The compressor is kept and reset for the next chunk rather than rebuilt.
+        pcompressor->done();
+        pcompressor->reset();
+        chunks.push_back({ chunk_state.points_in_chunk,
+            (uint32_t)(chunk_state.write_offset - chunk_state.last_chunk_write_offset) });
+        noteChunkSize(chunks.back());
+        chunk_state.last_chunk_write_offset = chunk_state.write_offset;
+    }
+    chunk_state.points_in_chunk = 0;
+}
+
+void basic_file::Private::setChunkBytes(uint32_t bytes)
+{
+    if (chunk_size != io::VariableChunkSize)
+        throw error("Chunks can only be sized by bytes when the chunk size is variable.");
+    if (started())
+        throw error("The chunk byte budget must be set before writing points.");
+    chunk_bytes = bytes;
+}
+
+// Number of points at which the current chunk ends.
+uint32_t basic_file::Private::chunkLimit() const
+{
+    if (chunk_bytes == 0)
+        return chunk_size;
+
+    // Until a chunk has been compressed, assume four to one compression.
+    double perPoint = bytes_per_point ? bytes_per_point : header.point_record_length / 4.0;
+    double limit = chunk_bytes / perPoint;
+    return (uint32_t)(std::max)(1.0, (std::min)(limit, (double)io::DefaultChunkSize * 100));
+}
+
+// Use the compressed size of a finished chunk to size the ones that follow.
+void basic_file::Private::noteChunkSize(const chunk& c)
+{
+    if (c.count)
+        bytes_per_point = (double)c.size / c.count;
+}
+
+void basic_file::Private::setChunkStats(bool on)
+{
+    if (started())
+        throw error("Chunk statistics must be requested before writing points.");
+    if (on && (!compressed() || !seekable || header.version.minor != 4))
+        throw error("Chunk statistics can only be written to a seekable, compressed "
+            "LAS 1.4 file.");
+    keep_stats = on;
+}
+
+// Add a run of points from one chunk to the statistics of the chunk.
+void basic_file::Private::addStats(const char *p, size_t count)
+{
+    const size_t pointLen = header.point_record_length;
+    const field gps = findField(header.point_format_id, reader::column::GpsTime);
+    const field cls = findField(header.point_format_id, reader::column::Classification);
+
+    int32_t mins[3] = { (std::numeric_limits<int32_t>::max)(),
+        (std::numeric_limits<int32_t>::max)(), (std::numeric_limits<int32_t>::max)() };
+    int32_t maxs[3] = { std::numeric_limits<int32_t>::lowest(),
+        std::numeric_limits<int32_t>::lowest(), std::numeric_limits<int32_t>::lowest() };
+    chunk_stats_vlr::stats& s = chunk_stat;
+    for (size_t i = 0; i < count; ++i, p += pointLen)
+    {
+        int32_t xyz[3];
+        memcpy(xyz, p, sizeof(xyz));
+        for (int d = 0; d < 3; ++d)
         {
-            pcompressor = build_las_compressor(stream->cb(), header.point_format_id,
-                header.ebCount());
+            mins[d] = (std::min)(mins[d], xyz[d]);
+            maxs[d] = (std::max)(maxs[d], xyz[d]);
         }
-        else if (chunk_state.points_in_chunk == chunk_size)
+
+        if (gps.k != field::Missing)
         {
-            pcompressor->done();
-            chunk_state.points_in_chunk = 0;
-            std::streamsize offset = f->tellp();
-            chunk_sizes.push_back(offset - chunk_state.last_chunk_write_offset);
-            chunk_state.last_chunk_write_offset = offset;
-            pcompressor = build_las_compressor(stream->cb(), header.point_format_id,
-                header.ebCount());
+            double t;
+            memcpy(&t, p + gps.offset, sizeof(t));
+            s.min_gps_time = (std::min)(s.min_gps_time, t);
+            s.max_gps_time = (std::max)(s.max_gps_time, t);
         }
 
-        // now write the point
-        pcompressor->compress(p);
+        uint8_t c = (uint8_t)p[cls.offset];
+        if (cls.mask)
+            c = (c >> cls.shift) & cls.mask;
+        s.classes[c]++;
+    }
+    if (count == 0)
+        return;
+
+    const double scale[3] = { header.scale.x, header.scale.y, header.scale.z };
+    const double offset[3] = { header.offset.x, header.offset.y, header.offset.z };
+    for (int d = 0; d < 3; ++d)
+    {
+        double lo = mins[d] * scale[d] + offset[d];
+        double hi = maxs[d] * scale[d] + offset[d];
+        if (lo > hi)
+            std::swap(lo, hi);
+        s.minimum[d] = (std::min)(lo, s.minimum[d]);
+        s.maximum[d] = (std::max)(hi, s.maximum[d]);
+    }
+}
+
+// Write the EVLRs kept from a file being appended to and the chunk statistics.
+void basic_file::Private::writeEvlrs()
+{
+    if (!keep_stats && kept_evlr_count == 0)
+        return;
+
+    // The EVLRs follow the chunk table.
+    uint64_t evlr_offset = chunk_state.write_offset;
+    uint32_t evlr_count = kept_evlr_count;
+
+    putBytes(reinterpret_cast<const unsigned char *>(kept_evlrs.data()), kept_evlrs.size());
+    if (keep_stats)
+    {
+        vlr::evlr_header h = stats.evlrHeader();
+        putBytes(reinterpret_cast<unsigned char *>(&h), sizeof(h));
+        std::vector<char> buf = stats.data();
+        putBytes(reinterpret_cast<unsigned char *>(buf.data()), buf.size());
+        evlr_count++;
     }
-    chunk_state.total_written++;
-    chunk_state.points_in_chunk++;
-    updateMinMax(*(reinterpret_cast<const las::point10*>(p)));
+
+    // The EVLR offset and count follow the 1.2 header and the waveform offset.
+    uint64_t end = chunk_state.write_offset;
+    seekOut(sizeof(io::header) + sizeof(header14.wave_offset));
+    putBytes(reinterpret_cast<unsigned char *>(&evlr_offset), sizeof(evlr_offset));
+    putBytes(reinterpret_cast<unsigned char *>(&evlr_count), sizeof(evlr_count));
+    seekOut(end);
+}
+
+void basic_file::Private::flushChunk()
+{
+    if (chunk_size != io::VariableChunkSize)
+        throw error("Chunks can only be flushed when the chunk size is variable.");
+    endChunk();
+}
+
+// Hand the buffered points of a chunk to the pool for compression. The chunk's size
+// is filled in when it has been compressed.
+void basic_file::Private::queueChunk()
+{
+    chunks.push_back({ chunk_state.points_in_chunk, 0 });
+
+    std::shared_ptr<std::vector<char>> points(new std::vector<char>);
+    points->swap(chunk_points);
+    const int format = header.point_format_id;
+    const size_t ebCount = header.ebCount();
+    const size_t pointLen = header.point_record_length;
+
+    encoded_chunks.push_back(pool->add<std::vector<unsigned char>>(
+        [points, format, ebCount, pointLen]()
+        {
+            MemoryStream out;
+            las_compressor::ptr compressor =
+                build_las_compressor(out.outCb(), format, ebCount);
+            for (size_t pos = 0; pos < points->size(); pos += pointLen)
+                compressor->compress(points->data() + pos);
+            compressor->done();
+            return std::move(out.buf);
+        }
+    ));
+
+    // Limit the number of chunks held in memory.
+    while (encoded_chunks.size() > 2 * pool->size())
+        writeEncodedChunk();
+}
+
+// Write the oldest compressed chunk to the output.
+void basic_file::Private::writeEncodedChunk()
+{
+    std::vector<unsigned char> buf = encoded_chunks.front().get();
+    chunk& c = chunks[chunks.size() - encoded_chunks.size()];
+    c.size = (uint32_t)buf.size();
+    noteChunkSize(c);
+    encoded_chunks.pop_front();
+
+    putBytes(buf.data(), buf.size());
+    chunk_state.last_chunk_write_offset += buf.size();
 }
 
 void basic_file::Private::close()
 {
     if (compressed())
     {
-        pcompressor->done();
-
-        // Note down the size of the offset of this last chunk
-        chunk_sizes.push_back((std::streamsize)f->tellp() - chunk_state.last_chunk_write_offset);
+        writeTail();
+        endChunk();
+        while (encoded_chunks.size())
+            writeEncodedChunk();
     }
 
-    writeHeader();
+    // The header of an output that can't seek has already been written.
+    if (seekable)
+        writeHeader();
     if (compressed())
         writeChunkTable();
+    writeEvlrs();
+    // Wait for the last of the output, which reports any failure to write it.
+    if (async_stream)
+        async_stream->flush();
+    async_stream.reset();
 }
 
 void basic_file::Private::writeHeader()
@@ -449,22 +1897,66 @@ void basic_file::Private::writeHeader()
     eb_vlr ebVlr(header.ebCount());
 
     // point_format_id and point_record_length  are set on open().
-    header.header_size = (header.version.minor == 4 ? sizeof(io::header14) : sizeof(io::header));
-    header.point_offset = header.header_size;
-    header.vlr_count = 0;
-    if (compressed())
+    // The layout of a file being appended to stays as it is.
+    if (appending)
+        header.point_format_id |= (1 << 7);
+    else
     {
-       header.point_offset += lazVlr.size() + lazVlr.header().size();
-       header.vlr_count++;
-       header.point_format_id |= (1 << 7);
+        header.header_size = (header.version.minor == 4 ?
+            sizeof(io::header14) : sizeof(io::header));
+        header.point_offset = header.header_size;
+        header.vlr_count = 0;
+        if (compressed())
+        {
+           header.point_offset += lazVlr.size() + lazVlr.header().size();
+           header.vlr_count++;
+           header.point_format_id |= (1 << 7);
+        }
+        if (header.ebCount())
+        {
+            header.point_offset += ebVlr.size() + ebVlr.header().size();
+            header.vlr_count++;
+        }
     }
-    if (header.ebCount())
+
+    // The point counts of an output that can't seek come from the caller: the 64-bit
+    // counts of a 1.4 header if it supplied them and the legacy counts otherwise.
+    uint64_t total = chunk_state.total_written;
+    uint64_t byReturn[15];
+    std::copy(points_by_return, points_by_return + 15, byReturn);
+    if (!seekable)
     {
-        header.point_offset += ebVlr.size() + ebVlr.header().size();
-        header.vlr_count++;
+        if (header.version.minor == 4 && header14.point_count_14)
+        {
+            total = header14.point_count_14;
+            std::copy(header14.points_by_return_14, header14.points_by_return_14 + 15,
+                byReturn);
+        }
+        else
+        {
+            total = header.point_count;
+            std::fill(byReturn, byReturn + 15, 0);
+            std::copy(header.points_by_return, header.points_by_return + 5, byReturn);
+        }
     }
 
-    header.point_count = static_cast<unsigned int>(chunk_state.total_written);
+    if (header.version.minor < 4 && total > (std::numeric_limits<uint32_t>::max)())
+        throw error("A LAS 1." + std::to_string(header.version.minor) +
+            " file can't hold more than 4294967295 points.");
+
+    // LAS 1.4 has 64-bit counts. The legacy counts are only set for the legacy
+    // point formats, and then only if the count fits.
+    bool legacy = header.version.minor < 4 ||
+        ((header.point_format_id & 0x3F) < 6 &&
+            total <= (std::numeric_limits<uint32_t>::max)());
+    header.point_count = legacy ? (uint32_t)total : 0;
+    for (int i = 0; i < 5; ++i)
+        header.points_by_return[i] = legacy ? (uint32_t)byReturn[i] : 0;
+    if (header.version.minor == 4)
+    {
+        header14.point_count_14 = total;
+        std::copy(byReturn, byReturn + 15, header14.points_by_return_14);
+    }
 
     //HUH?
     // make sure we re-arrange mins and maxs for writing
@@ -477,42 +1969,50 @@ void basic_file::Private::writeHeader()
     header.minimum.z = my; header.maximum.x = ny;
     header.maximum.y = mz; header.maximum.z = nz;
 
-    if (header.version.minor == 4)
+    if (header.version.minor == 4 && !appending)
     {
-        header14.point_count_14 = header.point_count;
         // Set the WKT bit.
         header.global_encoding |= (1 << 4);
     }
 
-    f->seekp(0);
-    f->write(reinterpret_cast<char*>(&header), header.header_size);
+    if (seekable)
+        seekOut(0);
+    if (appending)
+    {
+        // Leave the VLRs and anything past the header fields we know alone.
+        size_t size = header.version.minor == 4 ? sizeof(io::header14) : sizeof(io::header);
+        putBytes(reinterpret_cast<unsigned char *>(&header),
+            (std::min)(size, (size_t)header.header_size));
+        return;
+    }
+    putBytes(reinterpret_cast<unsigned char *>(&header), header.header_size);
 
     if (compressed())
     {
         // Write the VLR.
         vlr::vlr_header h = lazVlr.header();
-        f->write(reinterpret_cast<char *>(&h), sizeof(h));
+        putBytes(reinterpret_cast<unsigned char *>(&h), sizeof(h));
 
         std::vector<char> vlrbuf = lazVlr.data();
-        f->write(vlrbuf.data(), vlrbuf.size());
+        putBytes(reinterpret_cast<unsigned char *>(vlrbuf.data()), vlrbuf.size());
     }
     if (header.ebCount())
     {
         vlr::vlr_header h = ebVlr.header();
-        f->write(reinterpret_cast<char *>(&h), sizeof(h));
+        putBytes(reinterpret_cast<unsigned char *>(&h), sizeof(h));
 
         std::vector<char> vlrbuf = ebVlr.data();
-        f->write(vlrbuf.data(), vlrbuf.size());
+        putBytes(reinterpret_cast<unsigned char *>(vlrbuf.data()), vlrbuf.size());
     }
 }
 
 void basic_file::Private::writeChunkTable()
 {
-    // move to the end of the file to start emitting our compresed table
-    f->seekp(0, std::ios::end);
-
-    // take note of where we're writing the chunk table, we need this later
-    int64_t chunk_table_offset = static_cast<int64_t>(f->tellp());
+    // The chunk table follows the last chunk. Take note of where that is, we need
+    // this later.
+    int64_t chunk_table_offset = chunk_state.last_chunk_write_offset;
+    if (seekable)
+        seekOut(chunk_table_offset);
 
     // write out the chunk table header (version and total chunks)
 #pragma pack(push, 1)
@@ -520,30 +2020,24 @@ void basic_file::Private::writeChunkTable()
     {
         unsigned int version,
         chunks_count;
-    } chunk_table_header = { 0, static_cast<unsigned int>(chunk_sizes.size()) };
+    } chunk_table_header = { 0, static_cast<unsigned int>(chunks.size()) };
 #pragma pack(pop)
 
-    f->write(reinterpret_cast<char*>(&chunk_table_header), sizeof(chunk_table_header));
+    putBytes(reinterpret_cast<unsigned char *>(&chunk_table_header),
+        sizeof(chunk_table_header));
 
     // Now compress and write the chunk table
-    OutFileStream w(*f);
-    OutCbStream outStream(w.cb());
-
-    encoders::arithmetic<OutCbStream> encoder(outStream);
-    compressors::integer comp(32, 2);
-
-    comp.init();
-
-    for (size_t i = 0 ; i < chunk_sizes.size() ; i ++)
-    {
-        comp.compress(encoder, i ? static_cast<int>(chunk_sizes[i - 1]) : 0,
-            static_cast<int>(chunk_sizes[i]), 1);
-    }
-    encoder.done();
-
-    // go back to where we're supposed to write chunk table offset
-    f->seekp(header.point_offset);
-    f->write(reinterpret_cast<char*>(&chunk_table_offset), sizeof(chunk_table_offset));
+    compress_chunk_table(dataCb(), chunks, chunk_size == io::VariableChunkSize);
+
+    // An output that can't seek ends with the offset. Otherwise go back to where
+    // we're supposed to write the chunk table offset and then return to the end.
+    uint64_t end = chunk_state.write_offset;
+    if (seekable)
+        seekOut(header.point_offset);
+    putBytes(reinterpret_cast<unsigned char *>(&chunk_table_offset),
+        sizeof(chunk_table_offset));
+    if (seekable)
+        seekOut(end);
 }
 
 
@@ -558,14 +2052,56 @@ bool basic_file::compressed() const
     return p_->compressed();
 }
 
-void basic_file::open(std::ostream& out, const io::header& h, uint32_t chunk_size)
+void basic_file::open(std::ostream& out, const io::header& h, uint32_t chunk_size,
+    bool seekable)
 {
-    p_->open(out, h, chunk_size);
+    p_->open(out, h, chunk_size, seekable);
+}
+
+void basic_file::open(std::ostream& out, const io::header14& h, uint32_t chunk_size,
+    bool seekable)
+{
+    p_->open(out, h, chunk_size, seekable);
+}
+
+void basic_file::append(std::iostream& io)
+{
+    p_->append(io);
+}
+
+void basic_file::setThreads(unsigned threads)
+{
+    p_->setThreads(threads);
+}
+
+void basic_file::setAsyncWrites(bool on)
+{
+    p_->setAsyncWrites(on);
 }
 
 void basic_file::writePoint(const char *buf)
 {
-    p_->writePoint(buf);
+    p_->writePoints(buf, 1);
+}
+
+void basic_file::writePoints(const char *buf, size_t count)
+{
+    p_->writePoints(buf, count);
+}
+
+void basic_file::flushChunk()
+{
+    p_->flushChunk();
+}
+
+void basic_file::setChunkBytes(uint32_t bytes)
+{
+    p_->setChunkBytes(bytes);
+}
+
+void basic_file::setChunkStats(bool on)
+{
+    p_->setChunkStats(on);
 }
 
 void basic_file::close()
@@ -573,6 +2109,42 @@ void basic_file::close()
     p_->close();
 }
 
+// generic_file
+
+generic_file::generic_file(std::ostream& out, const io::header& h, uint32_t chunk_size,
+        bool seekable)
+{
+    open(out, h, chunk_size, seekable);
+}
+
+generic_file::generic_file(std::ostream& out, const io::header14& h, uint32_t chunk_size,
+        bool seekable)
+{
+    open(out, h, chunk_size, seekable);
+}
+
+// mem_file
+
+mem_file::mem_file(const io::header& h, uint32_t chunk_size)
+{
+    p_->open(new OutMemStream, h, chunk_size);
+}
+
+mem_file::mem_file(char *buf, size_t capacity, const io::header& h, uint32_t chunk_size)
+{
+    p_->open(new OutMemStream(buf, capacity), h, chunk_size);
+}
+
+const char *mem_file::data() const
+{
+    return p_->mem_stream->data();
+}
+
+size_t mem_file::size() const
+{
+    return p_->mem_stream->size();
+}
+
 // named_file
 
 named_file::config::config() : scale(1.0, 1.0, 1.0), offset(0.0, 0.0, 0.0),
@@ -585,7 +2157,7 @@ named_file::config::config(const io::vector3& s, const io::vector3& o, unsigned
 
 named_file::config::config(const io::header& h) : scale(h.scale.x, h.scale.y, h.scale.z),
     offset(h.offset.x, h.offset.y, h.offset.z), chunk_size(io::DefaultChunkSize),
-    pdrf(h.point_format_id), extra_bytes(h.ebCount())
+    pdrf(h.point_format_id), minor_version(h.version.minor), extra_bytes(h.ebCount())
 {}
 
 io::header named_file::config::to_header() const
@@ -617,10 +2189,132 @@ void named_file::Private::open(const std::string& filename, const named_file::co
 
     // open the file and move to offset of data, we'll write
     // headers and all other things on file close
-    f.open(filename, std::ios::binary | std::ios::trunc);
+    f.open(filename, std::ios::binary | std::ios::out | std::ios::trunc);
     if (!f.good())
         throw error("Couldn't open '" + filename + "' for writing.");
-    base->open(f, h, c.chunk_size);
+    base->open(f, h, c.chunk_size, true);
+}
+
+void named_file::Private::append(const std::string& filename)
+{
+    f.open(filename, std::ios::binary | std::ios::in | std::ios::out);
+    if (!f.good())
+        throw error("Couldn't open '" + filename + "' for appending.");
+    this->filename = filename;
+    base->append(f);
+}
+
+#ifdef _WIN32
+
+void named_file::Private::map(const std::string& filename, const named_file::config& c,
+    uint64_t cap)
+{
+    HANDLE h = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+        throw error("Couldn't open '" + filename + "' for writing.");
+    file = h;
+
+    HANDLE mapping = CreateFileMappingA(h, NULL, PAGE_READWRITE, (DWORD)(cap >> 32),
+        (DWORD)cap, NULL);
+    if (mapping)
+    {
+        data = (char *)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+        // The view keeps the mapping open.
+        CloseHandle(mapping);
+    }
+    if (!data)
+    {
+        unmap();
+        throw error("Couldn't map '" + filename + "'.");
+    }
+    capacity = cap;
+    base->open(new OutMemStream(data, (size_t)cap), c.to_header(), c.chunk_size);
+}
+
+// Unmap the file and cut it to the size written.
+void named_file::Private::unmap()
+{
+    if (!file)
+        return;
+    LARGE_INTEGER size;
+    size.QuadPart = base->mem_stream ? base->mem_stream->size() : 0;
+    if (data)
+        UnmapViewOfFile(data);
+    SetFilePointerEx(file, size, NULL, FILE_BEGIN);
+    SetEndOfFile(file);
+    CloseHandle(file);
+    data = nullptr;
+    file = nullptr;
+}
+
+// Cut off what's left of the original file past the end of what was written.
+void named_file::Private::truncate(uint64_t size)
+{
+    HANDLE h = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+        throw error("Couldn't open '" + filename + "' to truncate it.");
+    LARGE_INTEGER pos;
+    pos.QuadPart = size;
+    bool ok = SetFilePointerEx(h, pos, NULL, FILE_BEGIN) && SetEndOfFile(h);
+    CloseHandle(h);
+    if (!ok)
+        throw error("Couldn't truncate '" + filename + "'.");
+}
+
+#else
+
+void named_file::Private::map(const std::string& filename, const named_file::config& c,
+    uint64_t cap)
+{
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+        throw error("Couldn't open '" + filename + "' for writing.");
+
+    void *addr = MAP_FAILED;
+    if (cap && ftruncate(fd, (off_t)cap) == 0)
+        addr = mmap(nullptr, (size_t)cap, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        unmap();
+        throw error("Couldn't map '" + filename + "'.");
+    }
+    data = (char *)addr;
+    capacity = cap;
+    base->open(new OutMemStream(data, (size_t)cap), c.to_header(), c.chunk_size);
+}
+
+// Unmap the file and cut it to the size written.
+void named_file::Private::unmap()
+{
+    if (fd < 0)
+        return;
+    off_t size = base->mem_stream ? (off_t)base->mem_stream->size() : 0;
+    if (data)
+        munmap(data, (size_t)capacity);
+    // If the file can't be cut it's left padded with zeros, which readers ignore.
+    if (ftruncate(fd, size) != 0)
+    {}
+    ::close(fd);
+    data = nullptr;
+    fd = -1;
+}
+
+// Cut off what's left of the original file past the end of what was written.
+void named_file::Private::truncate(uint64_t size)
+{
+    if (::truncate(filename.c_str(), (off_t)size) != 0)
+        throw error("Couldn't truncate '" + filename + "'.");
+}
+
+#endif
+
+named_file::Private::~Private()
+{
+    // Finish any writes to the file before it's closed.
+    base->async_stream.reset();
+    unmap();
 }
 
 
@@ -628,7 +2322,18 @@ named_file::named_file(const std::string& filename, const named_file::config& c)
     p_(new Private(basic_file::p_.get()))
 {
     p_->open(filename, c);
-}    
+}
+
+named_file::named_file(const std::string& filename, const named_file::config& c,
+        uint64_t capacity) : p_(new Private(basic_file::p_.get()))
+{
+    p_->map(filename, c, capacity);
+}
+
+named_file::named_file(const std::string& filename) : p_(new Private(basic_file::p_.get()))
+{
+    p_->append(filename);
+}
 
 named_file::~named_file()
 {}
@@ -638,6 +2343,9 @@ void named_file::close()
     basic_file::close();
     if (p_->f.is_open())
         p_->f.close();
+    p_->unmap();
+    if (p_->base->appending)
+        p_->truncate(p_->base->chunk_state.write_offset);
 }
 
 } // namespace writer
@@ -32,6 +32,7 @@
 
 #include <cstdint>
 #include <fstream>
+#include <limits>
 
 #include "las.hpp"
 #include "streams.hpp"
@@ -45,6 +46,8 @@ namespace lazperf
 namespace io
 {
 const uint32_t DefaultChunkSize = 50000;
+// Chunks end only when the writer is told to end them (see writer::basic_file).
+const uint32_t VariableChunkSize = 0xFFFFFFFF;
 
 #pragma pack(push, 1)
 struct vector3
@@ -115,6 +118,78 @@ struct header14 : public header
 namespace reader
 {
 
+// Where readColumns() puts one dimension. 'dest' receives a value of 'type' for each
+// point, 'stride' bytes apart (0 packs the values tightly). X, Y and Z are scaled and
+// offset when 'type' is Float or Double, and are the raw integers otherwise. An
+// integer type must hold every value of the dimension: a signed dimension such as
+// ScanAngle can't be read as an unsigned type, nor a dimension into a narrower type.
+struct column
+{
+    enum dimension
+    {
+        X,
+        Y,
+        Z,
+        Intensity,
+        ReturnNumber,
+        NumberOfReturns,
+        ScanDirectionFlag,
+        EdgeOfFlightLine,
+        Classification,
+        ClassFlags,
+        ScannerChannel,
+        ScanAngle,
+        UserData,
+        PointSourceId,
+        GpsTime,
+        Red,
+        Green,
+        Blue,
+        Nir
+    };
+
+    enum value_type
+    {
+        Int8,
+        Uint8,
+        Int16,
+        Uint16,
+        Int32,
+        Uint32,
+        Int64,
+        Uint64,
+        Float,
+        Double
+    };
+
+    dimension dim;
+    value_type type;
+    void *dest;
+    size_t stride;
+};
+
+// Limits on the points wanted from a file. A chunk is skipped when its statistics
+// (see writer::basic_file::setChunkStats()) show that none of its points can pass.
+// Points in chunks that are read aren't checked. A default filter passes everything.
+struct filter
+{
+    filter() : minimum(-Inf, -Inf, -Inf), maximum(Inf, Inf, Inf),
+        min_gps_time(-Inf), max_gps_time(Inf)
+    {}
+
+    // Bounds in scaled coordinates.
+    io::vector3 minimum;
+    io::vector3 maximum;
+    // Ignored for point formats without GPS time.
+    double min_gps_time;
+    double max_gps_time;
+    // Classifications to accept. Empty accepts all.
+    std::vector<uint8_t> classes;
+
+private:
+    static constexpr double Inf = std::numeric_limits<double>::infinity();
+};
+
 class basic_file
 {
     FRIEND_TEST(io_tests, parses_laszip_vlr_correctly);
@@ -125,11 +200,50 @@ protected:
     ~basic_file();
 
     void open(std::istream& in);
+    // Read from 'count' bytes of memory at 'buf', which must outlive the reader.
+    void open(const char *buf, size_t count);
+    // Stop any decoding in progress. Call before releasing the source.
+    void close();
 
 public:
     size_t pointCount() const;
     const io::header& header() const;
     void readPoint(char *out);
+    // Read 'count' consecutive points into 'out', which must have room for
+    // count * header().point_record_length bytes.
+    void readPoints(char *out, size_t count);
+    // Read 'count' consecutive points into the per-dimension arrays described by
+    // 'columns'. Throws if a dimension isn't part of the point format or can't be stored
+    // as its column's type.
+    void readColumns(const std::vector<column>& columns, size_t count);
+    void seek(uint64_t pointIndex);
+    // Skip chunks that can't hold points passing 'f' and restart reading from the
+    // first point. With a filter, reads and seeks that reach a skipped chunk go on
+    // to the next chunk that isn't skipped. A file without chunk statistics has no
+    // chunks skipped, so every point is read; false is returned in that case.
+    bool setFilter(const filter& f);
+    // Number of points in the chunks that aren't skipped.
+    uint64_t filteredPointCount() const;
+    // Decode chunks in parallel on 'threads' worker threads. Points are still returned
+    // in file order. A value of 0 or 1 decodes on the calling thread.
+    void setThreads(unsigned threads);
+    // Decode only the named layers (see lazperf::layer) of PDRF 6-8 data. The data for
+    // the other layers is skipped and their fields hold the value from the first point
+    // of each chunk. Other formats are always fully decoded.
+    void setLayers(uint32_t layers);
+    // Rebuild the chunk table of a PDRF 6-8 file from the chunk headers rather than
+    // trusting the stored table, and restart reading from the first point. This
+    // happens on open if the stored table is missing or damaged.
+    void rebuildChunkTable();
+    // Append the chunk table in use to 'out', a stream open for writing on the same
+    // file, and update the chunk table offset to match.
+    void writeChunkTable(std::ostream& out);
+    // The number of points and compressed size of each chunk of a compressed file.
+    std::vector<chunk> chunks() const;
+    // The LASzip VLR of a compressed file.
+    const laz_vlr& lazVlr() const;
+    // The chunk statistics stored in the file. Empty if there are none.
+    const std::vector<chunk_stats_vlr::stats>& chunkStats() const;
 
 private:
     // The file object is not copyable or copy constructible
@@ -139,16 +253,11 @@ private:
     std::unique_ptr<Private> p_;
 };
 
+// Decodes straight from 'buf', which must outlive the file.
 class mem_file : public basic_file
 {
-    struct Private;
-
 public:
     mem_file(char *buf, size_t count);
-    ~mem_file();
-
-private:
-    std::unique_ptr<Private> p_;
 };
 
 class generic_file : public basic_file
@@ -162,7 +271,16 @@ class named_file : public basic_file
     struct Private;
 
 public:
-    named_file(const std::string& filename);
+    // How the file is read. 'stream' reads through std::ifstream. The 'map' modes map
+    // the file into memory and advise the OS to expect sequential or random access.
+    enum access
+    {
+        stream,
+        map_sequential,
+        map_random
+    };
+
+    named_file(const std::string& filename, access mode = stream);
     ~named_file();
 
 private:
@@ -184,8 +302,47 @@ protected:
     virtual ~basic_file();
 
 public:
-    void open(std::ostream& out, const io::header& h, uint32_t chunk_size);
+    // If the output can't seek (a pipe, say), set 'seekable' to false. The header
+    // is then written from 'h' right away, so its point count and bounds must be
+    // filled in up front or fixed up later. The chunk table offset in the header is
+    // -1 and the real offset is written at the end of the output. The counts of a
+    // LAS 1.4 output that can't seek are taken from 'point_count_14' and
+    // 'points_by_return_14' when 'h' is a 1.4 header; otherwise from the legacy fields.
+    void open(std::ostream& out, const io::header& h, uint32_t chunk_size,
+        bool seekable = true);
+    void open(std::ostream& out, const io::header14& h, uint32_t chunk_size,
+        bool seekable = true);
+    // Add points to the existing compressed file in 'io'. The existing chunks are kept
+    // as they are, except that a short last chunk of a file with fixed-size chunks is
+    // decoded and written again with the first of the new points. The chunk table,
+    // header and chunk statistics, if the file has them, are rewritten on close(), and
+    // any other EVLRs are written again after the chunk table. Should the file end up
+    // shorter than before, the bytes past its new end are left in 'io' (named_file cuts
+    // them off).
+    void append(std::iostream& io);
+    // Compress chunks in parallel on 'threads' worker threads. The output is the same
+    // as when compressing on the calling thread, which is what a value of 0 or 1 does.
+    // Must be called before the first point is written.
+    void setThreads(unsigned threads);
+    // Write to the output stream on a separate thread, so that compression doesn't
+    // wait on the output. Must be called before the first point is written. Has no
+    // effect when writing to memory.
+    void setAsyncWrites(bool on);
     void writePoint(const char *p);
+    // Write 'count' consecutive points from 'p'.
+    void writePoints(const char *p, size_t count);
+    // End the current chunk so that the next point starts a new one. Only allowed
+    // when the chunk size is io::VariableChunkSize.
+    void flushChunk();
+    // End chunks when they are expected to compress to about 'bytes', based on the
+    // chunks compressed so far. Only allowed when the chunk size is
+    // io::VariableChunkSize, and must be called before the first point is written.
+    void setChunkBytes(uint32_t bytes);
+    // Record the bounds, GPS time range and classification counts of each chunk in
+    // an EVLR, which the reader can use to skip chunks (see reader::filter). Only for
+    // compressed LAS 1.4 files on a seekable output, and must be called before the
+    // first point is written.
+    void setChunkStats(bool on);
     void close();
     virtual bool compressed() const;
 
@@ -193,6 +350,29 @@ protected:
     std::unique_ptr<Private> p_; 
 };
 
+class generic_file : public basic_file
+{
+public:
+    generic_file(std::ostream& out, const io::header& h,
+        uint32_t chunk_size = io::DefaultChunkSize, bool seekable = true);
+    generic_file(std::ostream& out, const io::header14& h,
+        uint32_t chunk_size = io::DefaultChunkSize, bool seekable = true);
+};
+
+// Writes to memory that grows as needed or to a block supplied by the caller, which
+// must be big enough for the whole file.
+class mem_file : public basic_file
+{
+public:
+    mem_file(const io::header& h, uint32_t chunk_size = io::DefaultChunkSize);
+    mem_file(char *buf, size_t capacity, const io::header& h,
+        uint32_t chunk_size = io::DefaultChunkSize);
+
+    // The file written, which is complete after close().
+    const char *data() const;
+    size_t size() const;
+};
+
 class named_file : public basic_file
 {
     struct Private;
@@ -217,6 +397,11 @@ public:
     };
 
     named_file(const std::string& filename, const config& c);
+    // Write through a mapping of the file, which is created 'capacity' bytes long and
+    // cut to its real size on close(). Writing more than 'capacity' bytes throws.
+    named_file(const std::string& filename, const config& c, uint64_t capacity);
+    // Add points to an existing compressed file (see basic_file::append()).
+    explicit named_file(const std::string& filename);
     virtual ~named_file();
 
     void close();
@@ -16,7 +16,11 @@
 
 // NOTE: This file exists to facilitate testing of private code.
 
+#include <deque>
+#include <future>
+
 #include "io.hpp"
+#include "threadpool.hpp"
 
 namespace lazperf
 {
@@ -25,15 +29,46 @@ namespace reader
 
 struct basic_file::Private
 {
-    Private() : header(header14), compressed(false)
+    Private() : mem_data(nullptr), header(header14), compressed(false), layers(layer::All),
+        threads(0),
+        next_chunk(0)
     {}
 
+    void open(const char *buf, size_t count);
+    void close();
+    InputCb dataCb();
+    las_decompressor::ptr dataDecompressor();
+    void resetDecompressor();
+    void seekData(uint64_t pos);
+    void readData(uint64_t pos, char *buf, size_t count);
+
     void readPoint(char *out);
+    void readPoints(char *out, size_t count);
+    void readColumns(const std::vector<column>& columns, size_t count);
+    void seek(uint64_t pointIndex);
+    void setThreads(unsigned threads);
+    void setLayers(uint32_t layers);
+    uint64_t pointCount() const;
+    uint64_t chunkPoints(uint64_t chunk) const;
+    uint64_t chunkFirstPoint(uint64_t chunk) const;
+    bool variableChunks() const;
+    void nextChunk();
+    void nextDecodedChunk();
+    void queueChunks();
     void loadHeader();
     void fixMinMax();
     void parseVLRs();
     void parseLASZIPVLR(const char *);
     void parseChunkTable();
+    void scanChunkTable();
+    void rebuildChunkTable();
+    void restart();
+    void parseEVLRs();
+    bool setFilter(const filter& f);
+    uint64_t filteredPointCount() const;
+    bool chunkSelected(uint64_t chunk) const;
+    std::vector<chunk> chunkTable() const;
+    void writeChunkTable(std::ostream& out);
     void validateHeader();
 
     struct ChunkState
@@ -47,29 +82,41 @@ struct basic_file::Private
     } chunk_state;
     std::istream *f;
     std::unique_ptr<InFileStream> stream;
+    // Memory-backed source. When set, 'f' reads the memory through mem_buf.
+    const char *mem_data;
+    std::unique_ptr<InMemStream> mem_stream;
+    std::unique_ptr<charbuf> mem_buf;
+    std::unique_ptr<std::istream> mem_f;
     io::header& header;
     io::header14 header14;
     laz_vlr laz;
     std::vector<uint64_t> chunk_table_offsets;
+    std::vector<uint64_t> chunk_table_points; // index of the first point in each chunk
     bool compressed;
     las_decompressor::ptr pdecompressor;
-};
-
-struct mem_file::Private
-{
-    Private(char *buf, size_t count) : sbuf(buf, count), f(&sbuf)
-    {}
-
-    charbuf sbuf;
-    std::istream f;
+    uint32_t layers;
+    chunk_stats_vlr stats;
+    std::vector<bool> chunk_selected; // empty when every chunk is read
+
+    // Parallel decoding.
+    unsigned threads;
+    std::unique_ptr<ThreadPool> pool;
+    std::deque<std::pair<uint64_t, std::future<std::vector<char>>>> decoded_chunks;
+    std::vector<char> chunk_points;
+    uint64_t next_chunk;
 };
 
 struct named_file::Private
 {
-    Private(const std::string& filename) : f(filename, std::ios::binary)
+    Private() : data(nullptr), size(0)
     {}
+    ~Private();
+
+    void map(const std::string& filename, named_file::access mode);
 
     std::ifstream f;
+    char *data;
+    size_t size;
 };
 
 } // namespace reader
@@ -79,14 +126,38 @@ namespace writer
 
 struct basic_file::Private
 {
-    Private() : header(header14), chunk_size(io::DefaultChunkSize), f(nullptr)
+    Private() : header(header14), chunk_size(io::DefaultChunkSize), f(nullptr),
+        seekable(true), appending(false), existing_points(0), kept_evlr_count(0),
+        points_by_return{}, chunk_bytes(0), bytes_per_point(0), keep_stats(false), threads(0)
     {}
 
     void close();
     bool compressed() const;
-    void open(std::ostream& out, const io::header& h, uint32_t chunk_size);
-    void writePoint(const char *p);
-    void updateMinMax(const las::point10& p);
+    void open(std::ostream& out, const io::header& h, uint32_t chunk_size, bool seekable);
+    void open(std::ostream& out, const io::header14& h, uint32_t chunk_size, bool seekable);
+    void open(OutMemStream *out, const io::header& h, uint32_t chunk_size);
+    void begin(const io::header& h, uint32_t chunk_size, bool seekable);
+    void append(std::iostream& io);
+    bool started() const;
+    void writeTail();
+    void putBytes(const unsigned char *b, size_t len);
+    void seekOut(uint64_t pos);
+    OutputCb dataCb();
+    void setThreads(unsigned threads);
+    void setAsyncWrites(bool on);
+    void writePoints(const char *p, size_t count);
+    void endChunk();
+    void flushChunk();
+    void setChunkBytes(uint32_t bytes);
+    uint32_t chunkLimit() const;
+    void noteChunkSize(const chunk& c);
+    void setChunkStats(bool on);
+    void addStats(const char *p, size_t count);
+    void writeEvlrs();
+    void queueChunk();
+    void writeEncodedChunk();
+    void updateMinMax(const char *p, size_t count);
+    void countReturns(const char *p, size_t count);
     void writeHeader();
     void writeChunks();
     void writeChunkTable();
@@ -96,10 +167,13 @@ struct basic_file::Private
         int64_t total_written; // total points written
         int64_t current_chunk_index; //  the current chunk index we're compressing
         unsigned int points_in_chunk;
+        unsigned int chunk_limit; // points in the current chunk when it's full
         std::streamsize last_chunk_write_offset;
+        std::streamsize write_offset; // position of the next write
 
         ChunkState() : total_written(0), current_chunk_index(-1),
-            points_in_chunk(0), last_chunk_write_offset(0)
+            points_in_chunk(0), chunk_limit(0), last_chunk_write_offset(0),
+            write_offset(0)
         {}
     } chunk_state;
     las_compressor::ptr pcompressor;
@@ -108,20 +182,64 @@ struct basic_file::Private
     unsigned int chunk_size;
     std::ostream *f;
     std::unique_ptr<OutFileStream> stream;
-    std::vector<int64_t> chunk_sizes; // all the places where chunks begin
+    std::unique_ptr<OutMemStream> mem_stream; // set when writing to memory
+    std::unique_ptr<OutAsyncStream> async_stream; // set when writing on another thread
+    bool seekable;
+    bool appending;
+    uint64_t existing_points; // points kept from the file being appended to
+    std::vector<char> tail_points; // points of a short last chunk to write again
+    std::vector<char> kept_evlrs; // EVLRs, with headers, of the file being appended to
+    uint32_t kept_evlr_count;
+    uint64_t points_by_return[15];
+    std::vector<chunk> chunks; // point counts and sizes for the chunk table
+
+    // Chunks sized to a compressed byte budget.
+    uint32_t chunk_bytes;
+    double bytes_per_point; // compressed size of a point in the last sized chunk
+
+    // Per-chunk statistics.
+    bool keep_stats;
+    chunk_stats_vlr stats;
+    chunk_stats_vlr::stats chunk_stat; // statistics of the current chunk
+
+    // Parallel encoding.
+    unsigned threads;
+    std::unique_ptr<ThreadPool> pool;
+    std::deque<std::future<std::vector<unsigned char>>> encoded_chunks;
+    std::vector<char> chunk_points;
 };
 
 struct named_file::Private
 {
     using Base = basic_file::Private;
 
-    Private(Base *b) : base(b)
+    Private(Base *b) : base(b), data(nullptr), capacity(0),
+#ifdef _WIN32
+        file(nullptr)
+#else
+        fd(-1)
+#endif
     {}
-    
+    ~Private();
+
     void open(const std::string& filename, const named_file::config& c);
+    void append(const std::string& filename);
+    void map(const std::string& filename, const named_file::config& c, uint64_t capacity);
+    void unmap();
+    void truncate(uint64_t size);
 
     Base *base;
-    std::ofstream f;
+    std::fstream f;
+    std::string filename; // set when appending
+
+    // Mapped output.
+    char *data;
+    uint64_t capacity;
+#ifdef _WIN32
+    void *file;
+#else
+    int fd;
+#endif
 };
 
 } // namespace writer
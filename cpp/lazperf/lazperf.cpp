@@ -38,6 +38,16 @@ point_compressor_base_1_2::~point_compressor_base_1_2()
 void point_compressor_base_1_2::done()
 {
     p_->encoder_.done();
+    p_->stream_.flush();
+}
+
+void point_compressor_base_1_2::reset()
+{
+    p_->encoder_.reset();
+    p_->point_.reset();
+    p_->gpstime_.reset();
+    p_->rgb_.reset();
+    p_->byte_.reset();
 }
 
 // COMPRESSOR 0
@@ -128,6 +138,15 @@ point_compressor_base_1_4::point_compressor_base_1_4(OutputCb cb, size_t ebCount
     p_(new Private(cb, ebCount))
 {}
 
+void point_compressor_base_1_4::reset()
+{
+    p_->chunk_count_ = 0;
+    p_->point_.reset();
+    p_->rgb_.reset();
+    p_->nir_.reset();
+    p_->byte_.reset();
+}
+
 // COMPRESOR 6
 
 point_compressor_6::~point_compressor_6()
@@ -158,6 +177,7 @@ void point_compressor_6::done()
     p_->point_.writeData();
     if (p_->byte_.count())
         p_->byte_.writeData();
+    p_->stream_.flush();
 }
 
 // COMPRESOR 7
@@ -193,6 +213,7 @@ void point_compressor_7::done()
     p_->rgb_.writeData();
     if (p_->byte_.count())
         p_->byte_.writeData();
+    p_->stream_.flush();
 }
 
 // COMPRESOR 8
@@ -231,6 +252,7 @@ void point_compressor_8::done()
     p_->nir_.writeData();
     if (p_->byte_.count())
         p_->byte_.writeData();
+    p_->stream_.flush();
 }
 
 // DECOMPRESSOR
@@ -242,7 +264,7 @@ las_decompressor::~las_decompressor()
 
 struct point_decompressor_base_1_2::Private
 {
-    Private(InputCb cb, size_t ebCount) : stream_(cb), decoder_(stream_), point_(decoder_),
+    Private(InCbStream stream, size_t ebCount) : stream_(stream), decoder_(stream_), point_(decoder_),
         gpstime_(decoder_), rgb_(decoder_), byte_(decoder_, ebCount), first_(true)
     {}
 
@@ -259,9 +281,23 @@ point_decompressor_base_1_2::point_decompressor_base_1_2(InputCb cb, size_t ebCo
     p_(new Private(cb, ebCount))
 {}
 
+point_decompressor_base_1_2::point_decompressor_base_1_2(InWindowStream& in, size_t ebCount) :
+    p_(new Private(in, ebCount))
+{}
+
 point_decompressor_base_1_2::~point_decompressor_base_1_2()
 {}
 
+void point_decompressor_base_1_2::reset()
+{
+    p_->decoder_.reset();
+    p_->point_.reset();
+    p_->gpstime_.reset();
+    p_->rgb_.reset();
+    p_->byte_.reset();
+    p_->first_ = true;
+}
+
 void point_decompressor_base_1_2::handleFirst()
 {
     if (p_->first_)
@@ -280,6 +316,10 @@ point_decompressor_0::point_decompressor_0(InputCb cb, size_t ebCount) :
     point_decompressor_base_1_2(cb, ebCount)
 {}
 
+point_decompressor_0::point_decompressor_0(InWindowStream& in, size_t ebCount) :
+    point_decompressor_base_1_2(in, ebCount)
+{}
+
 char *point_decompressor_0::decompress(char *in)
 {
     in = p_->point_.decompress(in);
@@ -297,6 +337,10 @@ point_decompressor_1::point_decompressor_1(InputCb cb, size_t ebCount) :
     point_decompressor_base_1_2(cb, ebCount)
 {}
 
+point_decompressor_1::point_decompressor_1(InWindowStream& in, size_t ebCount) :
+    point_decompressor_base_1_2(in, ebCount)
+{}
+
 char *point_decompressor_1::decompress(char *in)
 {
     in = p_->point_.decompress(in);
@@ -315,6 +359,10 @@ point_decompressor_2::point_decompressor_2(InputCb cb, size_t ebCount) :
     point_decompressor_base_1_2(cb, ebCount)
 {}
 
+point_decompressor_2::point_decompressor_2(InWindowStream& in, size_t ebCount) :
+    point_decompressor_base_1_2(in, ebCount)
+{}
+
 char *point_decompressor_2::decompress(char *in)
 {
     in = p_->point_.decompress(in);
@@ -333,6 +381,10 @@ point_decompressor_3::point_decompressor_3(InputCb cb, size_t ebCount) :
     point_decompressor_base_1_2(cb, ebCount)
 {}
 
+point_decompressor_3::point_decompressor_3(InWindowStream& in, size_t ebCount) :
+    point_decompressor_base_1_2(in, ebCount)
+{}
+
 char *point_decompressor_3::decompress(char *in)
 {
     in = p_->point_.decompress(in);
@@ -348,8 +400,9 @@ char *point_decompressor_3::decompress(char *in)
 struct point_decompressor_base_1_4::Private
 {
 public:
-    Private(InputCb cb, size_t ebCount) : cbStream_(cb), point_(cbStream_), rgb_(cbStream_),
-        nir_(cbStream_), byte_(cbStream_, ebCount), chunk_count_(0), first_(true)
+    Private(InCbStream stream, size_t ebCount, uint32_t layers) : cbStream_(stream),
+        point_(cbStream_, layers), rgb_(cbStream_, layers), nir_(cbStream_, layers),
+        byte_(cbStream_, ebCount, layers), chunk_count_(0), first_(true)
     {}
 
     InCbStream cbStream_;
@@ -361,14 +414,35 @@ public:
     bool first_;
 };
 
-point_decompressor_base_1_4::point_decompressor_base_1_4(InputCb cb, size_t ebCount) :
-    p_(new Private(cb, ebCount))
+point_decompressor_base_1_4::point_decompressor_base_1_4(InputCb cb, size_t ebCount,
+        uint32_t layers) :
+    p_(new Private(cb, ebCount, layers))
+{}
+
+point_decompressor_base_1_4::point_decompressor_base_1_4(InWindowStream& in, size_t ebCount,
+        uint32_t layers) :
+    p_(new Private(in, ebCount, layers))
 {}
+
+void point_decompressor_base_1_4::reset()
+{
+    p_->point_.reset();
+    p_->rgb_.reset();
+    p_->nir_.reset();
+    p_->byte_.reset();
+    p_->chunk_count_ = 0;
+    p_->first_ = true;
+}
     
 // DECOMPRESSOR 6
 
-point_decompressor_6::point_decompressor_6(InputCb cb, size_t ebCount) :
-    point_decompressor_base_1_4(cb, ebCount)
+point_decompressor_6::point_decompressor_6(InputCb cb, size_t ebCount, uint32_t layers) :
+    point_decompressor_base_1_4(cb, ebCount, layers)
+{}
+
+point_decompressor_6::point_decompressor_6(InWindowStream& in, size_t ebCount,
+        uint32_t layers) :
+    point_decompressor_base_1_4(in, ebCount, layers)
 {}
 
 point_decompressor_6::~point_decompressor_6()
@@ -407,8 +481,13 @@ char *point_decompressor_6::decompress(char *out)
 
 // DECOMPRESSOR 7
 
-point_decompressor_7::point_decompressor_7(InputCb cb, size_t ebCount) :
-    point_decompressor_base_1_4(cb, ebCount)
+point_decompressor_7::point_decompressor_7(InputCb cb, size_t ebCount, uint32_t layers) :
+    point_decompressor_base_1_4(cb, ebCount, layers)
+{}
+
+point_decompressor_7::point_decompressor_7(InWindowStream& in, size_t ebCount,
+        uint32_t layers) :
+    point_decompressor_base_1_4(in, ebCount, layers)
 {}
 
 point_decompressor_7::~point_decompressor_7()
@@ -451,8 +530,13 @@ char *point_decompressor_7::decompress(char *out)
 
 // DECOMPRESSOR 8
 
-point_decompressor_8::point_decompressor_8(InputCb cb, size_t ebCount) :
-    point_decompressor_base_1_4(cb, ebCount)
+point_decompressor_8::point_decompressor_8(InputCb cb, size_t ebCount, uint32_t layers) :
+    point_decompressor_base_1_4(cb, ebCount, layers)
+{}
+
+point_decompressor_8::point_decompressor_8(InWindowStream& in, size_t ebCount,
+        uint32_t layers) :
+    point_decompressor_base_1_4(in, ebCount, layers)
 {}
 
 point_decompressor_8::~point_decompressor_8()
@@ -529,37 +613,56 @@ las_compressor::ptr build_las_compressor(OutputCb cb, int format, size_t ebCount
     return compressor;
 }
 
-las_decompressor::ptr build_las_decompressor(InputCb cb, int format, size_t ebCount)
+namespace
+{
+
+template <typename TSource>
+las_decompressor::ptr buildDecompressor(TSource& in, int format, size_t ebCount,
+    uint32_t layers)
 {
     las_decompressor::ptr decompressor;
 
     switch (format)
     {
     case 0:
-        decompressor.reset(new point_decompressor_0(cb, ebCount));
+        decompressor.reset(new point_decompressor_0(in, ebCount));
         break;
     case 1:
-        decompressor.reset(new point_decompressor_1(cb, ebCount));
+        decompressor.reset(new point_decompressor_1(in, ebCount));
         break;
     case 2:
-        decompressor.reset(new point_decompressor_2(cb, ebCount));
+        decompressor.reset(new point_decompressor_2(in, ebCount));
         break;
     case 3:
-        decompressor.reset(new point_decompressor_3(cb, ebCount));
+        decompressor.reset(new point_decompressor_3(in, ebCount));
         break;
     case 6:
-        decompressor.reset(new point_decompressor_6(cb, ebCount));
+        decompressor.reset(new point_decompressor_6(in, ebCount, layers));
         break;
     case 7:
-        decompressor.reset(new point_decompressor_7(cb, ebCount));
+        decompressor.reset(new point_decompressor_7(in, ebCount, layers));
         break;
     case 8:
-        decompressor.reset(new point_decompressor_8(cb, ebCount));
+        decompressor.reset(new point_decompressor_8(in, ebCount, layers));
         break;
     }
     return decompressor;
 }
 
+} // unnamed namespace
+
+las_decompressor::ptr build_las_decompressor(InputCb cb, int format, size_t ebCount,
+    uint32_t layers)
+{
+    return buildDecompressor(cb, format, ebCount, layers);
+}
+
+las_decompressor::ptr build_las_decompressor(InWindowStream& in, int format, size_t ebCount,
+    uint32_t layers)
+{
+    return buildDecompressor(in, format, ebCount, layers);
+}
+
 // CHUNK TABLE
 
 void compress_chunk_table(OutputCb cb, const std::vector<uint32_t>& chunks)
@@ -577,6 +680,7 @@ void compress_chunk_table(OutputCb cb, const std::vector<uint32_t>& chunks)
         predictor = chunk;
     }
     encoder.done();
+    stream.flush();
 }
 
 std::vector<uint32_t> decompress_chunk_table(InputCb cb, size_t numChunks)
@@ -599,4 +703,58 @@ std::vector<uint32_t> decompress_chunk_table(InputCb cb, size_t numChunks)
     return chunks;
 }
 
+void compress_chunk_table(OutputCb cb, const std::vector<chunk>& chunks, bool variable)
+{
+    OutCbStream stream(cb);
+    encoders::arithmetic<OutCbStream> encoder(stream);
+    compressors::integer compressor(32, 2);
+    uint32_t countPredictor = 0;
+    uint32_t sizePredictor = 0;
+
+    compressor.init();
+    for (const chunk& c : chunks)
+    {
+        if (variable)
+        {
+            uint32_t count = htole32(c.count);
+            compressor.compress(encoder, countPredictor, count, 0);
+            countPredictor = count;
+        }
+        uint32_t size = htole32(c.size);
+        compressor.compress(encoder, sizePredictor, size, 1);
+        sizePredictor = size;
+    }
+    encoder.done();
+    stream.flush();
+}
+
+std::vector<chunk> decompress_chunk_table(InputCb cb, size_t numChunks, bool variable)
+{
+    std::vector<chunk> chunks;
+
+    InCbStream stream(cb);
+    decoders::arithmetic<InCbStream> decoder(stream);
+    decompressors::integer decomp(32, 2);
+
+    decoder.readInitBytes();
+    decomp.init();
+
+    // Counts and sizes are each predicted from the previous value of the same kind.
+    uint32_t countPredictor = 0;
+    uint32_t sizePredictor = 0;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        chunk c {};
+        if (variable)
+        {
+            countPredictor = decomp.decompress(decoder, countPredictor, 0);
+            c.count = le32toh(countPredictor);
+        }
+        sizePredictor = decomp.decompress(decoder, sizePredictor, 1);
+        c.size = le32toh(sizePredictor);
+        chunks.push_back(c);
+    }
+    return chunks;
+}
+
 } // namespace lazperf
@@ -55,6 +55,27 @@ using OutputCb = std::function<void(const unsigned char *, size_t)>;
 // Called when compressed input is to be read.
 using InputCb = std::function<void(unsigned char *, size_t)>;
 
+struct InWindowStream;
+
+// Layers of PDRF 6-8 data that can be selected for decoding. XY, return numbers,
+// scanner channel and the change flags are always decoded. The fields of layers that
+// aren't decoded hold their value from the first point of the chunk.
+namespace layer
+{
+const uint32_t Z = 1 << 0;
+const uint32_t Classification = 1 << 1;
+const uint32_t Flags = 1 << 2;
+const uint32_t Intensity = 1 << 3;
+const uint32_t ScanAngle = 1 << 4;
+const uint32_t UserData = 1 << 5;
+const uint32_t PointSourceId = 1 << 6;
+const uint32_t GpsTime = 1 << 7;
+const uint32_t Rgb = 1 << 8;
+const uint32_t Nir = 1 << 9;
+const uint32_t ExtraBytes = 1 << 10;
+const uint32_t All = 0xFFFFFFFF;
+} // namespace layer
+
 class las_compressor
 {
 public:
@@ -62,6 +83,9 @@ public:
 
     LAZPERF_EXPORT virtual const char *compress(const char *in) = 0;
     LAZPERF_EXPORT virtual void done() = 0;
+    // Prepare to compress a new chunk after done() as if newly constructed, reusing
+    // the memory already allocated.
+    LAZPERF_EXPORT virtual void reset() = 0;
     LAZPERF_EXPORT virtual ~las_compressor();
 };
 
@@ -71,6 +95,9 @@ public:
     typedef std::shared_ptr<las_decompressor> ptr;
 
     LAZPERF_EXPORT virtual char *decompress(char *in) = 0;
+    // Prepare to decompress a new chunk as if newly constructed, reusing the memory
+    // already allocated. The source must be positioned at the start of the chunk.
+    LAZPERF_EXPORT virtual void reset() = 0;
     LAZPERF_EXPORT virtual ~las_decompressor();
 };
 
@@ -80,6 +107,7 @@ class point_compressor_base_1_2 : public las_compressor
 
 public:
     LAZPERF_EXPORT void done();
+    LAZPERF_EXPORT void reset();
 
 protected:
     point_compressor_base_1_2(OutputCb cb, size_t ebCount);
@@ -130,6 +158,7 @@ class point_compressor_base_1_4 : public las_compressor
 
 public:
     virtual const char *compress(const char *in) = 0;
+    LAZPERF_EXPORT void reset();
 
 protected:
     point_compressor_base_1_4(OutputCb cb, size_t ebCount);
@@ -177,10 +206,12 @@ class point_decompressor_base_1_2 : public las_decompressor
 
 public:
     virtual char *decompress(char *in) = 0;
+    LAZPERF_EXPORT void reset();
     virtual ~point_decompressor_base_1_2();
 
 protected:
     point_decompressor_base_1_2(InputCb cb, size_t ebCount);
+    point_decompressor_base_1_2(InWindowStream& in, size_t ebCount);
     void handleFirst();
 
     std::unique_ptr<Private> p_;
@@ -190,6 +221,7 @@ class point_decompressor_0 : public point_decompressor_base_1_2
 {
 public:
     LAZPERF_EXPORT point_decompressor_0(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_0(InWindowStream& in, size_t ebCount = 0);
     LAZPERF_EXPORT ~point_decompressor_0();
 
     LAZPERF_EXPORT virtual char *decompress(char *in);
@@ -199,6 +231,7 @@ class point_decompressor_1 : public point_decompressor_base_1_2
 {
 public:
     LAZPERF_EXPORT point_decompressor_1(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_1(InWindowStream& in, size_t ebCount = 0);
     LAZPERF_EXPORT ~point_decompressor_1();
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
@@ -208,6 +241,7 @@ class point_decompressor_2 : public point_decompressor_base_1_2
 {
 public:
     LAZPERF_EXPORT point_decompressor_2(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_2(InWindowStream& in, size_t ebCount = 0);
     LAZPERF_EXPORT ~point_decompressor_2();
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
@@ -217,6 +251,7 @@ class point_decompressor_3 : public point_decompressor_base_1_2
 {
 public:
     LAZPERF_EXPORT point_decompressor_3(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_3(InWindowStream& in, size_t ebCount = 0);
     LAZPERF_EXPORT ~point_decompressor_3();
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
@@ -228,9 +263,11 @@ class point_decompressor_base_1_4 : public las_decompressor
 
 public:
     virtual char *decompress(char *out) = 0;
+    LAZPERF_EXPORT void reset();
 
 protected:
-    point_decompressor_base_1_4(InputCb cb, size_t ebCount);
+    point_decompressor_base_1_4(InputCb cb, size_t ebCount, uint32_t layers);
+    point_decompressor_base_1_4(InWindowStream& in, size_t ebCount, uint32_t layers);
 
     std::unique_ptr<Private> p_;
 };
@@ -238,7 +275,10 @@ protected:
 class point_decompressor_6 : public point_decompressor_base_1_4
 {
 public:
-    LAZPERF_EXPORT point_decompressor_6(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_6(InputCb cb, size_t ebCount = 0,
+        uint32_t layers = layer::All);
+    LAZPERF_EXPORT point_decompressor_6(InWindowStream& in, size_t ebCount = 0,
+        uint32_t layers = layer::All);
     LAZPERF_EXPORT ~point_decompressor_6();
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
@@ -247,7 +287,10 @@ public:
 class point_decompressor_7 : public point_decompressor_base_1_4
 {
 public:
-    LAZPERF_EXPORT point_decompressor_7(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_7(InputCb cb, size_t ebCount = 0,
+        uint32_t layers = layer::All);
+    LAZPERF_EXPORT point_decompressor_7(InWindowStream& in, size_t ebCount = 0,
+        uint32_t layers = layer::All);
     LAZPERF_EXPORT ~point_decompressor_7();
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
@@ -257,17 +300,27 @@ struct point_decompressor_8 : public point_decompressor_base_1_4
 {
 public:
     LAZPERF_EXPORT ~point_decompressor_8();
-    LAZPERF_EXPORT point_decompressor_8(InputCb cb, size_t ebCount = 0);
+    LAZPERF_EXPORT point_decompressor_8(InputCb cb, size_t ebCount = 0,
+        uint32_t layers = layer::All);
+    LAZPERF_EXPORT point_decompressor_8(InWindowStream& in, size_t ebCount = 0,
+        uint32_t layers = layer::All);
 
     LAZPERF_EXPORT virtual char *decompress(char *out);
 };
 
 // FACTORY
 
+// Compressed data is passed to the callback in large blocks. The last of it is passed
+// by done().
 LAZPERF_EXPORT las_compressor::ptr build_las_compressor(OutputCb, int format,
     size_t ebCount = 0);
+// 'layers' only applies to PDRF 6-8.
 LAZPERF_EXPORT las_decompressor::ptr build_las_decompressor(InputCb, int format,
-    size_t ebCount = 0);
+    size_t ebCount = 0, uint32_t layers = layer::All);
+// Decode from the window of a buffered stream (see InWindowStream), starting at the
+// stream's current position.
+LAZPERF_EXPORT las_decompressor::ptr build_las_decompressor(InWindowStream& in, int format,
+    size_t ebCount = 0, uint32_t layers = layer::All);
 
 // CHUNK TABLE
 
@@ -275,5 +328,17 @@ LAZPERF_EXPORT las_decompressor::ptr build_las_decompressor(InputCb, int format,
 LAZPERF_EXPORT void compress_chunk_table(OutputCb cb, const std::vector<uint32_t>& chunks);
 LAZPERF_EXPORT std::vector<uint32_t> decompress_chunk_table(InputCb cb, size_t numChunks);
 
+// Tables for variable-sized chunks also hold the number of points in each chunk.
+struct chunk
+{
+    uint32_t count;
+    uint32_t size;
+};
+
+LAZPERF_EXPORT void compress_chunk_table(OutputCb cb, const std::vector<chunk>& chunks,
+    bool variable);
+LAZPERF_EXPORT std::vector<chunk> decompress_chunk_table(InputCb cb, size_t numChunks,
+    bool variable);
+
 } // namespace lazperf
 
@@ -144,6 +144,16 @@ namespace models
 				return *this;
 			}
 
+			// Return to the initial, equiprobable state without reallocating.
+			void reset() {
+				total_count = 0;
+				update_cycle = symbols;
+				for (uint32_t k = 0; k < symbols; k++) symbol_count[k] = 1;
+
+				update();
+				symbols_until_update = update_cycle = (symbols + 6) >> 1;
+			}
+
 			inline void update() {
 				// halve counts when a threshold is reached
 				if ((total_count += update_cycle) > DM__MaxCount) {
@@ -224,6 +234,13 @@ namespace models
 				return *this;
 			}
 
+			void reset() {
+				bit_0_count = 1;
+				bit_count   = 2;
+				bit_0_prob  = 1U << (BM__LengthShift - 1);
+				update_cycle = bits_until_update = 4;
+			}
+
 			void update() {
 				// halve counts when a threshold is reached
 				if ((bit_count += update_cycle) > BM__MaxCount)
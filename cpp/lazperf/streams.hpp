@@ -29,6 +29,7 @@
 #ifndef __streams_hpp__
 #define __streams_hpp__
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -40,31 +41,67 @@
 namespace lazperf
 {
 
+// Collects output and passes it to the callback a block at a time. Call flush()
+// to pass on what's left when done.
 struct OutCbStream
 {
+    static const size_t BlockSize = 1 << 16;
+
     OutCbStream(OutputCb outCb) : outCb_(outCb)
-    {}
+    {
+        buf_.reserve(BlockSize);
+    }
 
     void putBytes(const unsigned char *b, size_t len)
     {
-        outCb_(b, len);
+        if (buf_.size() + len > BlockSize)
+        {
+            flush();
+            // Big writes go straight through.
+            if (len >= BlockSize)
+            {
+                outCb_(b, len);
+                return;
+            }
+        }
+        buf_.insert(buf_.end(), b, b + len);
     }
 
     void putByte(const unsigned char b)
     {
-        outCb_(&b, 1);
+        buf_.push_back(b);
+        if (buf_.size() == BlockSize)
+            flush();
+    }
+
+    void flush()
+    {
+        if (buf_.size())
+        {
+            outCb_(buf_.data(), buf_.size());
+            buf_.clear();
+        }
     }
 
     OutputCb outCb_;
+    std::vector<unsigned char> buf_;
 };
 
 struct InCbStream
 {
-    InCbStream(InputCb inCb) : inCb_(inCb)
+    InCbStream(InputCb inCb) : inCb_(inCb), win_(nullptr)
+    {}
+
+    // Read from the window of a buffered stream rather than through a callback
+    // for each byte.
+    InCbStream(InWindowStream& win) : win_(&win)
     {}
 
     unsigned char getByte()
     {
+        if (win_)
+            return win_->getByte();
+
         unsigned char c;
         inCb_(&c, 1);
         return c;
@@ -72,10 +109,32 @@ struct InCbStream
 
     void getBytes(unsigned char *b, size_t len)
     {
-        inCb_(b, len);
+        if (win_)
+            win_->getBytes(b, len);
+        else
+            inCb_(b, len);
+    }
+
+    // A callback can't skip, so the bytes are read into scratch space and dropped.
+    void skipBytes(size_t len)
+    {
+        if (win_)
+        {
+            win_->skipBytes(len);
+            return;
+        }
+
+        unsigned char scratch[256];
+        while (len)
+        {
+            size_t count = (std::min)(len, sizeof(scratch));
+            inCb_(scratch, count);
+            len -= count;
+        }
     }
 
     InputCb inCb_;
+    InWindowStream *win_;
 };
 
 struct MemoryStream
@@ -85,8 +144,7 @@ struct MemoryStream
 
     void putBytes(const unsigned char* b, size_t len)
     {
-        while(len --)
-            buf.push_back(*b++);
+        buf.insert(buf.end(), b, b + len);
     }
 
     void putByte(const unsigned char b)
@@ -129,9 +187,17 @@ struct MemoryStream
     void copy(TSrc& in, size_t bytes)
     {
         buf.resize(bytes);
+        idx = 0;
         in.getBytes(buf.data(), bytes);
     }
 
+    // Empty the stream, keeping its storage.
+    void clear()
+    {
+        buf.clear();
+        idx = 0;
+    }
+
     const uint8_t *data() const
     { return buf.data(); }
 
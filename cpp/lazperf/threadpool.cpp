@@ -0,0 +1,62 @@
+/*
+===============================================================================
+
+  FILE:  threadpool.cpp
+
+  CONTENTS:
+    Simple worker pool used for parallel chunk processing
+
+  CHANGE HISTORY:
+
+===============================================================================
+*/
+
+#include "threadpool.hpp"
+
+namespace lazperf
+{
+
+ThreadPool::ThreadPool(size_t numThreads) : stop_(false)
+{
+    for (size_t i = 0; i < numThreads; ++i)
+        threads_.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_)
+        t.join();
+}
+
+void ThreadPool::queue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(task);
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this](){ return stop_ || !tasks_.empty(); });
+            if (stop_)
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+} // namespace lazperf
@@ -0,0 +1,59 @@
+/*
+===============================================================================
+
+  FILE:  threadpool.hpp
+
+  CONTENTS:
+    Simple worker pool used for parallel chunk processing
+
+  CHANGE HISTORY:
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace lazperf
+{
+
+class ThreadPool
+{
+public:
+    ThreadPool(size_t numThreads);
+    ~ThreadPool();
+
+    size_t size() const
+    { return threads_.size(); }
+
+    // Queue a task and return a future for its result. Tasks that haven't started
+    // when the pool is destroyed are dropped.
+    template<typename T>
+    std::future<T> add(std::function<T()> func)
+    {
+        auto task = std::make_shared<std::packaged_task<T()>>(func);
+        std::future<T> future = task->get_future();
+        queue([task](){ (*task)(); });
+        return future;
+    }
+
+private:
+    void queue(std::function<void()> task);
+    void run();
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+};
+
+} // namespace lazperf
@@ -37,6 +37,8 @@
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
+#include <memory>
+#include <utility>
 
 #ifdef NDEBUG
 #define LAZDEBUG(e) ((void)0)
@@ -357,6 +359,38 @@ public:
     }
 };
 
+// An object for each of N indexes, each created when its index is first used.
+template<typename T, size_t N>
+class lazy_array
+{
+public:
+    // Get the object at an index, creating it from the arguments if need be.
+    template<typename... Args>
+    T& get(size_t i, Args&&... args)
+    {
+        std::unique_ptr<T>& p = items_[i];
+        if (!p)
+            p.reset(new T(std::forward<Args>(args)...));
+        return *p;
+    }
+
+    // Get an object that already exists.
+    T& operator[](size_t i)
+    { return *items_[i]; }
+
+    // Call f for each object that has been created.
+    template<typename F>
+    void forEach(F f)
+    {
+        for (std::unique_ptr<T>& p : items_)
+            if (p)
+                f(*p);
+    }
+
+private:
+    std::array<std::unique_ptr<T>, N> items_;
+};
+
 } // namespace utils
 } // namespace lazperf
 
@@ -28,8 +28,12 @@
 ===============================================================================
 */
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <string>
 
+#include "excepts.hpp"
 #include "portable_endian.hpp"
 #include "utils.hpp"
 #include "vlr.hpp"
@@ -40,6 +44,9 @@ namespace lazperf
 size_t vlr::vlr_header::size() const
 { return sizeof(vlr::vlr_header); }
 
+size_t vlr::evlr_header::size() const
+{ return sizeof(vlr::evlr_header); }
+
 // LAZ VLR
 
 namespace
@@ -200,7 +207,7 @@ void eb_vlr::addField()
     ebfield field;
 
     std::string name = "FIELD_" + std::to_string(items.size());
-    memcpy(field.name, name.data(), 32);
+    memcpy(field.name, name.data(), (std::min)(name.size(), sizeof(field.name)));
 
     items.push_back(field);
 }
@@ -223,4 +230,117 @@ vlr::vlr_header eb_vlr::header() const
     return vlr_header { 0, "LASF_Spec", 4, (uint16_t)size(), ""  };
 }
 
+// CHUNK STATS VLR
+
+namespace
+{
+    const char *StatsUserId = "lazperf";
+    const uint16_t StatsRecordId = 100;
+    // Six bounds, two times and the classification counts.
+    const size_t StatsSize = 8 * sizeof(double) + 256 * sizeof(uint32_t);
+}
+
+chunk_stats_vlr::stats::stats() : min_gps_time((std::numeric_limits<double>::max)()),
+    max_gps_time(std::numeric_limits<double>::lowest()), classes{}
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        minimum[i] = (std::numeric_limits<double>::max)();
+        maximum[i] = std::numeric_limits<double>::lowest();
+    }
+}
+
+chunk_stats_vlr::chunk_stats_vlr()
+{}
+
+chunk_stats_vlr::chunk_stats_vlr(const char *data, size_t size)
+{
+    fill(data, size);
+}
+
+size_t chunk_stats_vlr::size() const
+{
+    return sizeof(uint32_t) + chunks.size() * StatsSize;
+}
+
+vlr::vlr_header chunk_stats_vlr::header() const
+{
+    if (size() > (std::numeric_limits<uint16_t>::max)())
+        throw error("Chunk statistics too large for a VLR.");
+    vlr::vlr_header h { 0, "", StatsRecordId, (uint16_t)size(), "chunk statistics" };
+    strncpy(h.user_id, StatsUserId, sizeof(h.user_id));
+    return h;
+}
+
+vlr::evlr_header chunk_stats_vlr::evlrHeader() const
+{
+    vlr::evlr_header h { 0, "", StatsRecordId, size(), "chunk statistics" };
+    strncpy(h.user_id, StatsUserId, sizeof(h.user_id));
+    return h;
+}
+
+bool chunk_stats_vlr::matches(const vlr::evlr_header& h)
+{
+    return strncmp(h.user_id, StatsUserId, sizeof(h.user_id)) == 0 &&
+        h.record_id == StatsRecordId;
+}
+
+void chunk_stats_vlr::fill(const char *data, size_t size)
+{
+    using namespace utils;
+
+    chunks.clear();
+    if (size < sizeof(uint32_t))
+        return;
+    uint32_t count = unpack<uint32_t>(data);    data += sizeof(count);
+    if (size < sizeof(uint32_t) + count * StatsSize)
+        return;
+
+    chunks.resize(count);
+    for (stats& s : chunks)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            s.minimum[i] = unpack<double>(data);    data += sizeof(double);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            s.maximum[i] = unpack<double>(data);    data += sizeof(double);
+        }
+        s.min_gps_time = unpack<double>(data);      data += sizeof(double);
+        s.max_gps_time = unpack<double>(data);      data += sizeof(double);
+        for (uint32_t& c : s.classes)
+        {
+            c = unpack<uint32_t>(data);             data += sizeof(uint32_t);
+        }
+    }
+}
+
+std::vector<char> chunk_stats_vlr::data() const
+{
+    using namespace utils;
+
+    std::vector<char> buf(size());
+    char *dst = buf.data();
+    pack((uint32_t)chunks.size(), dst);         dst += sizeof(uint32_t);
+    for (const stats& s : chunks)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            pack(s.minimum[i], dst);            dst += sizeof(double);
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            pack(s.maximum[i], dst);            dst += sizeof(double);
+        }
+        pack(s.min_gps_time, dst);              dst += sizeof(double);
+        pack(s.max_gps_time, dst);              dst += sizeof(double);
+        for (uint32_t c : s.classes)
+        {
+            pack(c, dst);                       dst += sizeof(uint32_t);
+        }
+    }
+    return buf;
+}
+
 } // namespace lazperf
@@ -52,6 +52,17 @@ public:
 
         size_t size() const;
     };
+
+    struct evlr_header
+    {
+        uint16_t reserved;
+        char user_id[16];
+        uint16_t record_id;
+        uint64_t record_length_after_header;
+        char description[32];
+
+        size_t size() const;
+    };
 #pragma pack(pop)
 
     LAZPERF_EXPORT virtual size_t size() const = 0;
@@ -121,5 +132,37 @@ public:
     LAZPERF_EXPORT void addField();
 };
 
+// Per-chunk bounds, GPS time range and classification counts, written as an EVLR
+// so that readers can skip chunks that can't hold the points they want.
+struct chunk_stats_vlr : public vlr
+{
+public:
+    struct stats
+    {
+        double minimum[3];
+        double maximum[3];
+        double min_gps_time;
+        double max_gps_time;
+        uint32_t classes[256];
+
+        LAZPERF_EXPORT stats();
+    };
+
+    std::vector<stats> chunks;
+
+    LAZPERF_EXPORT chunk_stats_vlr();
+    LAZPERF_EXPORT chunk_stats_vlr(const char *data, size_t size);
+
+    LAZPERF_EXPORT virtual size_t size() const;
+    LAZPERF_EXPORT virtual std::vector<char> data() const;
+    // The header to store the statistics as a VLR. Throws if they're too big for one.
+    LAZPERF_EXPORT virtual vlr_header header() const;
+    // The header to store the statistics as an EVLR, which is how they're written.
+    LAZPERF_EXPORT evlr_header evlrHeader() const;
+    LAZPERF_EXPORT void fill(const char *data, size_t size);
+    // Whether an EVLR header is for this record.
+    LAZPERF_EXPORT static bool matches(const vlr::evlr_header& h);
+};
+
 } // namesapce lazperf
 
@@ -30,6 +30,7 @@
 #pragma GCC diagnostic ignored "-Wfloat-equal"
 #endif
 
+#include <iterator>
 #include <memory>
 
 #include "test_main.hpp"
@@ -280,7 +281,8 @@ void compare(const std::string& compressed, const std::string& uncompressed)
     }
 }
 
-void encode(const std::string& lasFilename, const std::string& lazFilename)
+void encode(const std::string& lasFilename, const std::string& lazFilename,
+    unsigned threads = 0)
 {
     io::header h;
     std::ifstream lasStream(lasFilename, std::ios::binary);
@@ -291,6 +293,7 @@ void encode(const std::string& lasFilename, const std::string& lazFilename)
     lasStream.seekg(h.point_offset);
 
     writer::named_file f(lazFilename, writer::named_file::config(h));
+    f.setThreads(threads);
     char buf[1000];
     for (size_t i = 0; i < h.point_count; ++i)
     {
@@ -335,6 +338,72 @@ void checkExists(const std::string& filename) {
     f.close();
 }
 
+// Convert the autzen points to 'pdrf' (6, 7 or 8) with 'ebCount' extra bytes and
+// write them to 'filename'. Returns the converted points.
+std::vector<char> makeLaz14(const std::string& filename, int pdrf, int ebCount,
+    unsigned threads = 0)
+{
+    test::reader fin(testFile("autzen_trim.las"));
+    io::header h;
+    std::ifstream in(testFile("autzen_trim.las"), std::ios::binary);
+    in.read((char *)&h, sizeof(h));
+
+    writer::named_file::config c(h);
+    c.minor_version = 4;
+    c.pdrf = pdrf;
+    c.extra_bytes = ebCount;
+    const size_t len = c.to_header().point_record_length;
+
+    std::vector<char> points(fin.count_ * len);
+    std::vector<char> rec(fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+    {
+        fin.record(rec.data());
+        las::point10 p(rec.data());
+        double t;
+        memcpy(&t, rec.data() + 20, sizeof(t));
+
+        las::point14 q;
+        q.setX(p.x);
+        q.setY(p.y);
+        q.setZ(p.z);
+        q.setIntensity(p.intensity);
+        q.setReturnNum(p.return_number);
+        q.setNumReturns(p.number_of_returns_of_given_pulse);
+        q.setClassFlags(0);
+        q.setScannerChannel(i % 1000 < 500 ? 0 : 1);
+        q.setScanDirFlag(p.scan_direction_flag);
+        q.setEofFlag(p.edge_of_flight_line);
+        q.setClassification(p.classification);
+        q.setUserData(p.user_data);
+        q.setScanAngle(p.scan_angle_rank);
+        q.setPointSourceID(p.point_source_ID);
+        q.setGpsTime(t);
+
+        char *out = points.data() + i * len;
+        memcpy(out, &q, 30);
+        out += 30;
+        if (pdrf == 7 || pdrf == 8)
+        {
+            memcpy(out, rec.data() + 28, 6);
+            out += 6;
+        }
+        if (pdrf == 8)
+        {
+            memcpy(out, rec.data() + 28, 2);
+            out += 2;
+        }
+        for (int e = 0; e < ebCount; ++e)
+            *out++ = (char)(i / 7 + e);
+    }
+
+    writer::named_file f(filename, c);
+    f.setThreads(threads);
+    for (size_t i = 0; i < fin.count_; ++i)
+        f.writePoint(points.data() + i * len);
+    f.close();
+    return points;
+}
 
 TEST(io_tests, can_open_large_files)
 {
@@ -591,6 +660,1426 @@ TEST(io_tests, can_decode_large_files_from_memory)
     }
 }
 
+TEST(io_tests, can_seek)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file f(testFile("autzen_trim.laz"));
+    char buf[256];
+
+    // Seek around inside and across the 50000 point chunks.
+    for (uint64_t idx : { 75000, 0, 49999, 50000, 12345, 109999, 1 })
+    {
+        f.seek(idx);
+        f.readPoint(buf);
+        EXPECT_EQ(memcmp(buf, las.data() + idx * fin.size_, fin.size_), 0) << idx;
+    }
+
+    // Make sure that reading continues correctly over a chunk boundary after a seek.
+    f.seek(49998);
+    for (size_t idx = 49998; idx < 50003; ++idx)
+    {
+        f.readPoint(buf);
+        EXPECT_EQ(memcmp(buf, las.data() + idx * fin.size_, fin.size_), 0) << idx;
+    }
+
+    EXPECT_THROW(f.seek(110000), error);
+}
+
+TEST(io_tests, can_decode_in_parallel)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file f(testFile("autzen_trim.laz"));
+    char buf[256];
+
+    // Start serially and switch to parallel decoding part way through a chunk.
+    for (size_t i = 0; i < 20000; ++i)
+    {
+        f.readPoint(buf);
+        EXPECT_EQ(memcmp(buf, las.data() + i * fin.size_, fin.size_), 0) << i;
+    }
+    f.setThreads(4);
+    for (size_t i = 20000; i < fin.count_; ++i)
+    {
+        f.readPoint(buf);
+        EXPECT_EQ(memcmp(buf, las.data() + i * fin.size_, fin.size_), 0) << i;
+    }
+
+    f.seek(50001);
+    f.readPoint(buf);
+    EXPECT_EQ(memcmp(buf, las.data() + 50001 * fin.size_, fin.size_), 0);
+}
+
+TEST(io_tests, can_read_points_in_bulk)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    for (unsigned threads : { 0, 3 })
+    {
+        reader::named_file f(testFile("autzen_trim.laz"));
+        f.setThreads(threads);
+
+        std::vector<char> laz(las.size());
+        char *out = laz.data();
+        // Odd sized reads that cross the chunk boundaries.
+        for (size_t count : { 1, 7, 49999, 33333 })
+        {
+            f.readPoints(out, count);
+            out += count * fin.size_;
+        }
+        f.readPoints(out, (laz.data() + laz.size() - out) / fin.size_);
+        EXPECT_TRUE(las == laz) << threads;
+    }
+}
+
+TEST(io_tests, can_read_mapped_file)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    for (std::string name : { "autzen_trim.laz", "autzen_trim.las" })
+    {
+        reader::named_file f(testFile(name), reader::named_file::map_sequential);
+        std::vector<char> laz(las.size());
+        f.readPoints(laz.data(), f.pointCount());
+        EXPECT_TRUE(las == laz) << name;
+
+        reader::named_file r(testFile(name), reader::named_file::map_random);
+        r.setThreads(2);
+        std::vector<char> buf(fin.size_);
+        for (size_t i : { 99999, 3, 50000, 12345, 100001 })
+        {
+            r.seek(i);
+            r.readPoint(buf.data());
+            EXPECT_EQ(memcmp(buf.data(), las.data() + i * fin.size_, fin.size_), 0) << i;
+        }
+    }
+}
+
+TEST(io_tests, can_read_variable_chunks)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    // Rewrite the file as if it had been written with variable-sized chunks.
+    std::ifstream in(testFile("autzen_trim.laz"), std::ios::binary);
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+
+    io::header h;
+    memcpy(&h, buf.data(), sizeof(h));
+    uint64_t tableOffset;
+    memcpy(&tableOffset, buf.data() + h.point_offset, sizeof(tableOffset));
+    uint32_t numChunks;
+    memcpy(&numChunks, buf.data() + tableOffset + 4, sizeof(numChunks));
+
+    MemoryStream table;
+    table.buf.assign(buf.begin() + tableOffset + 8, buf.end());
+    std::vector<chunk> chunks = decompress_chunk_table(table.inCb(), numChunks, false);
+
+    uint64_t remaining = h.point_count;
+    for (chunk& c : chunks)
+    {
+        c.count = (uint32_t)(std::min)((uint64_t)50000, remaining);
+        remaining -= c.count;
+    }
+    table.buf.clear();
+    compress_chunk_table(table.outCb(), chunks, true);
+    buf.resize(tableOffset + 8);
+    buf.insert(buf.end(), table.buf.begin(), table.buf.end());
+
+    // The chunk size is 12 bytes into the LASzip VLR data, after the 54 byte VLR header.
+    std::string userId("laszip encoded");
+    auto pos = std::search(buf.begin(), buf.end(), userId.begin(), userId.end());
+    ASSERT_TRUE(pos != buf.end());
+    uint32_t chunkSize = (std::numeric_limits<uint32_t>::max)();
+    memcpy(&*pos - 2 + 54 + 12, &chunkSize, sizeof(chunkSize));
+
+    std::string filename(makeTempFileName());
+    std::ofstream out(filename, std::ios::binary);
+    out.write(buf.data(), buf.size());
+    out.close();
+
+    for (unsigned threads : { 0, 3 })
+    {
+        reader::named_file f(filename);
+        f.setThreads(threads);
+        std::vector<char> laz(las.size());
+        f.readPoints(laz.data(), f.pointCount());
+        EXPECT_TRUE(las == laz) << threads;
+
+        // Reading past the last chunk fails rather than running on.
+        std::vector<char> point(fin.size_);
+        EXPECT_THROW(f.readPoint(point.data()), error) << threads;
+        EXPECT_THROW(f.readPoints(point.data(), 2), error) << threads;
+
+        for (size_t i : { 100001, 50000, 49999, 7 })
+        {
+            f.seek(i);
+            f.readPoint(point.data());
+            EXPECT_EQ(memcmp(point.data(), las.data() + i * fin.size_, fin.size_), 0) << i;
+        }
+    }
+    std::remove(filename.c_str());
+}
+
+TEST(io_tests, can_read_trailing_chunk_table_offset)
+{
+    checkExists(testFile("autzen_trim.laz"));
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    // Move the chunk table offset to the end of the file, as a streaming writer would.
+    std::ifstream in(testFile("autzen_trim.laz"), std::ios::binary);
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+
+    io::header h;
+    memcpy(&h, buf.data(), sizeof(h));
+    int64_t tableOffset;
+    memcpy(&tableOffset, buf.data() + h.point_offset, sizeof(tableOffset));
+    int64_t unknown = -1;
+    memcpy(buf.data() + h.point_offset, &unknown, sizeof(unknown));
+    buf.insert(buf.end(), (char *)&tableOffset, (char *)&tableOffset + sizeof(tableOffset));
+
+    std::string filename(makeTempFileName());
+    std::ofstream out(filename, std::ios::binary);
+    out.write(buf.data(), buf.size());
+    out.close();
+
+    for (auto mode : { reader::named_file::stream, reader::named_file::map_sequential })
+    {
+        reader::named_file f(filename, mode);
+        std::vector<char> laz(las.size());
+        f.readPoints(laz.data(), f.pointCount());
+        EXPECT_TRUE(las == laz) << mode;
+
+        std::vector<char> point(fin.size_);
+        f.seek(100001);
+        f.readPoint(point.data());
+        EXPECT_EQ(memcmp(point.data(), las.data() + 100001 * fin.size_, fin.size_), 0);
+    }
+    std::remove(filename.c_str());
+}
+
+TEST(io_tests, can_rebuild_chunk_table)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 7, 3);
+
+    // Clobber the chunk table offset.
+    uint64_t tableOffset;
+    size_t pointLen;
+    {
+        reader::named_file f(filename);
+        pointLen = f.header().point_record_length;
+        std::ifstream in(filename, std::ios::binary);
+        in.seekg(f.header().point_offset);
+        in.read((char *)&tableOffset, sizeof(tableOffset));
+
+        std::fstream out(filename, std::ios::in | std::ios::out | std::ios::binary);
+        out.seekp(f.header().point_offset);
+        uint64_t bad = 12;
+        out.write((const char *)&bad, sizeof(bad));
+    }
+
+    auto check = [&](const std::string& name, size_t count)
+    {
+        for (unsigned threads : { 0, 2 })
+        {
+            reader::named_file f(name);
+            f.setThreads(threads);
+            std::vector<char> laz(count * pointLen);
+            f.readPoints(laz.data(), count);
+            EXPECT_EQ(memcmp(laz.data(), points.data(), laz.size()), 0) << threads;
+
+            std::vector<char> point(pointLen);
+            f.seek(count - 1);
+            f.readPoint(point.data());
+            EXPECT_EQ(memcmp(point.data(), points.data() + (count - 1) * pointLen,
+                pointLen), 0);
+        }
+    };
+
+    // The table is rebuilt on open.
+    check(filename, points.size() / pointLen);
+
+    // Write the rebuilt table back and make sure the file reads the same.
+    {
+        reader::named_file f(filename);
+        std::fstream out(filename, std::ios::in | std::ios::out | std::ios::binary);
+        f.writeChunkTable(out);
+    }
+    check(filename, points.size() / pointLen);
+
+    // A truncated file gives up the chunks that are complete.
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    buf.resize(tableOffset - 100);
+    std::string truncated(makeTempFileName());
+    std::ofstream out(truncated, std::ios::binary);
+    out.write(buf.data(), buf.size());
+    out.close();
+    check(truncated, 100000);
+
+    std::remove(filename.c_str());
+    std::remove(truncated.c_str());
+}
+
+TEST(io_tests, can_decode_selected_layers)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 8, 2);
+
+    for (auto mode : { reader::named_file::stream, reader::named_file::map_sequential })
+    for (unsigned threads : { 0, 2 })
+    {
+        reader::named_file f(filename, mode);
+        const size_t pointLen = f.header().point_record_length;
+        const size_t count = f.pointCount();
+        f.setThreads(threads);
+        f.setLayers(layer::Z | layer::Classification);
+
+        std::vector<char> laz(count * pointLen);
+        f.readPoints(laz.data(), count);
+        size_t bad = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const char *p = laz.data() + i * pointLen;
+            const char *q = points.data() + i * pointLen;
+            // XYZ, returns and classification.
+            if (memcmp(p, q, 12) || p[14] != q[14] || p[16] != q[16])
+                bad++;
+        }
+        EXPECT_EQ(bad, 0u) << std::to_string(mode) + "/" + std::to_string(threads);
+
+        // Back to all layers.
+        f.setLayers(layer::All);
+        f.seek(0);
+        f.readPoints(laz.data(), count);
+        EXPECT_TRUE(laz == points) << std::to_string(mode) + "/" + std::to_string(threads);
+    }
+
+    // A plain callback is never asked to skip; it just sees reads.
+    reader::named_file f(filename);
+    const io::header& h = f.header();
+    const size_t pointLen = h.point_record_length;
+    const size_t count = f.chunks()[0].count;
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> file((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    in.close();
+    const char *pos = file.data() + h.point_offset + sizeof(int64_t);
+    auto cb = [&pos](unsigned char *buf, size_t len)
+    {
+        memcpy(buf, pos, len);
+        pos += len;
+    };
+    las_decompressor::ptr d = build_las_decompressor(cb, h.point_format_id,
+        h.ebCount(), layer::Z | layer::Classification);
+    std::vector<char> laz(pointLen);
+    size_t bad = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        d->decompress(laz.data());
+        const char *q = points.data() + i * pointLen;
+        if (memcmp(laz.data(), q, 12) || laz[14] != q[14] || laz[16] != q[16])
+            bad++;
+    }
+    EXPECT_EQ(bad, 0u);
+    std::remove(filename.c_str());
+}
+
+TEST(io_tests, can_decode_14_from_memory)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 7, 1);
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(filename.c_str());
+
+    for (unsigned threads : { 0, 2 })
+    {
+        reader::mem_file f(buf.data(), buf.size());
+        const size_t pointLen = f.header().point_record_length;
+        const size_t count = f.pointCount();
+        f.setThreads(threads);
+
+        std::vector<char> laz(count * pointLen);
+        f.readPoints(laz.data(), count);
+        EXPECT_TRUE(laz == points) << std::to_string(threads);
+
+        f.seek(count / 2);
+        f.readPoints(laz.data(), count - count / 2);
+        EXPECT_EQ(memcmp(laz.data(), points.data() + (count / 2) * pointLen,
+            (count - count / 2) * pointLen), 0) << std::to_string(threads);
+    }
+}
+
+TEST(io_tests, can_read_columns)
+{
+    checkExists(testFile("autzen_trim.las"));
+    checkExists(testFile("autzen_trim.laz"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    reader::named_file f(testFile("autzen_trim.laz"));
+    const io::header& h = f.header();
+    const size_t count = f.pointCount();
+
+    // Interleaved doubles for XYZ, packed arrays for the rest.
+    std::vector<double> xyz(count * 3);
+    std::vector<int32_t> rawX(count);
+    std::vector<uint8_t> cls(count);
+    std::vector<uint8_t> returns(count);
+    std::vector<int16_t> angle(count);
+    std::vector<double> gps(count);
+    std::vector<uint16_t> blue(count);
+    std::vector<reader::column> columns {
+        { reader::column::X, reader::column::Double, xyz.data(), 3 * sizeof(double) },
+        { reader::column::Y, reader::column::Double, xyz.data() + 1, 3 * sizeof(double) },
+        { reader::column::Z, reader::column::Double, xyz.data() + 2, 3 * sizeof(double) },
+        { reader::column::X, reader::column::Int32, rawX.data(), 0 },
+        { reader::column::Classification, reader::column::Uint8, cls.data(), 0 },
+        { reader::column::NumberOfReturns, reader::column::Uint8, returns.data(), 0 },
+        { reader::column::ScanAngle, reader::column::Int16, angle.data(), 0 },
+        { reader::column::GpsTime, reader::column::Double, gps.data(), 0 },
+        { reader::column::Blue, reader::column::Uint16, blue.data(), 0 }
+    };
+    f.readColumns(columns, count);
+
+    std::vector<char> rec(fin.size_);
+    size_t bad = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        fin.record(rec.data());
+        las::point10 p(rec.data());
+        double t;
+        memcpy(&t, rec.data() + 20, sizeof(t));
+        uint16_t b;
+        memcpy(&b, rec.data() + 32, sizeof(b));
+
+        if (xyz[3 * i] != p.x * h.scale.x + h.offset.x ||
+            xyz[3 * i + 1] != p.y * h.scale.y + h.offset.y ||
+            xyz[3 * i + 2] != p.z * h.scale.z + h.offset.z ||
+            rawX[i] != p.x || cls[i] != p.classification ||
+            returns[i] != p.number_of_returns_of_given_pulse ||
+            angle[i] != p.scan_angle_rank || gps[i] != t || blue[i] != b)
+            bad++;
+    }
+    EXPECT_EQ(bad, 0u);
+
+    // There's no scanner channel in point format 3.
+    std::vector<reader::column> bogus {
+        { reader::column::ScannerChannel, reader::column::Uint8, cls.data(), 0 }
+    };
+    EXPECT_THROW(f.readColumns(bogus, 1), error);
+
+    // Values can't go to an unsigned or narrower type.
+    using col = reader::column;
+    std::vector<uint64_t> wide(count);
+    for (col c : { col{ col::X, col::Uint32, wide.data(), 0 },
+            col{ col::ScanAngle, col::Uint8, wide.data(), 0 },
+            col{ col::ScanAngle, col::Uint16, wide.data(), 0 },
+            col{ col::Intensity, col::Uint8, wide.data(), 0 },
+            col{ col::X, col::Int16, wide.data(), 0 },
+            col{ col::GpsTime, col::Int64, wide.data(), 0 },
+            col{ col::GpsTime, col::Float, wide.data(), 0 } })
+        EXPECT_THROW(f.readColumns({ c }, 1), error) << std::to_string(c.dim);
+
+    // But they can go to a wider one.
+    reader::named_file g(testFile("autzen_trim.laz"));
+    std::vector<int64_t> wideX(count);
+    std::vector<int32_t> wideAngle(count);
+    std::vector<uint32_t> wideIntensity(count);
+    g.readColumns({
+        { col::X, col::Int64, wideX.data(), 0 },
+        { col::ScanAngle, col::Int32, wideAngle.data(), 0 },
+        { col::Intensity, col::Uint32, wideIntensity.data(), 0 } }, count);
+    test::reader fin2(testFile("autzen_trim.las"));
+    bad = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        fin2.record(rec.data());
+        las::point10 p(rec.data());
+        if (wideX[i] != p.x || wideAngle[i] != p.scan_angle_rank ||
+                wideIntensity[i] != p.intensity)
+            bad++;
+    }
+    EXPECT_EQ(bad, 0u);
+}
+
+TEST(io_tests, can_read_columns_14)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 8, 0);
+
+    reader::named_file f(filename);
+    const size_t pointLen = f.header().point_record_length;
+    const size_t count = f.pointCount();
+
+    std::vector<uint8_t> returnNum(count);
+    std::vector<uint8_t> channel(count);
+    std::vector<float> angle(count);
+    std::vector<uint16_t> psid(count);
+    std::vector<uint16_t> nir(count);
+    std::vector<reader::column> columns {
+        { reader::column::ReturnNumber, reader::column::Uint8, returnNum.data(), 0 },
+        { reader::column::ScannerChannel, reader::column::Uint8, channel.data(), 0 },
+        { reader::column::ScanAngle, reader::column::Float, angle.data(), 0 },
+        { reader::column::PointSourceId, reader::column::Uint16, psid.data(), 0 },
+        { reader::column::Nir, reader::column::Uint16, nir.data(), 0 }
+    };
+    f.readColumns(columns, count);
+
+    size_t bad = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        las::point14 q(points.data() + i * pointLen);
+        uint16_t n;
+        memcpy(&n, points.data() + i * pointLen + 36, sizeof(n));
+
+        if (returnNum[i] != q.returnNum() || channel[i] != q.scannerChannel() ||
+            angle[i] != q.scanAngle() || psid[i] != q.pointSourceID() || nir[i] != n)
+            bad++;
+    }
+    EXPECT_EQ(bad, 0u);
+    std::remove(filename.c_str());
+}
+
+std::vector<char> readFile(const std::string& filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+}
+
+TEST(io_tests, can_decode_from_file_window)
+{
+    checkExists(testFile("autzen_trim.laz"));
+
+    reader::named_file f(testFile("autzen_trim.laz"));
+    const io::header& h = f.header();
+    const size_t count = f.chunks()[0].count;
+    std::vector<char> expected(count * h.point_record_length);
+    f.readPoints(expected.data(), count);
+
+    // Decode the first chunk through the window of a file stream and through
+    // its callback.
+    for (bool window : { true, false })
+    {
+        std::ifstream in(testFile("autzen_trim.laz"), std::ios::binary);
+        in.seekg(h.point_offset + sizeof(int64_t));
+        InFileStream stream(in);
+        las_decompressor::ptr d = window ?
+            build_las_decompressor(stream, h.point_format_id, h.ebCount()) :
+            build_las_decompressor(stream.cb(), h.point_format_id, h.ebCount());
+        std::vector<char> points(expected.size());
+        for (size_t i = 0; i < count; ++i)
+            d->decompress(points.data() + i * h.point_record_length);
+        EXPECT_TRUE(points == expected);
+    }
+
+    // Requests and skips that cross refills of the window.
+    std::vector<char> file = readFile(testFile("autzen_trim.las"));
+    std::ifstream in(testFile("autzen_trim.las"), std::ios::binary);
+    InFileStream stream(in);
+    std::vector<unsigned char> buf(file.size() - 2000000);
+    stream.getBytes(buf.data(), 1000000);
+    stream.skipBytes(2000000);
+    stream.getBytes(buf.data() + 1000000, buf.size() - 1000000);
+    EXPECT_EQ(memcmp(buf.data(), file.data(), 1000000), 0);
+    EXPECT_EQ(memcmp(buf.data() + 1000000, file.data() + 3000000, buf.size() - 1000000), 0);
+    EXPECT_THROW(stream.getByte(), error);
+}
+
+TEST(io_tests, can_encode_in_parallel)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string serial(makeTempFileName());
+    std::string parallel(makeTempFileName());
+
+    encode(testFile("autzen_trim.las"), serial);
+    encode(testFile("autzen_trim.las"), parallel, 4);
+    EXPECT_TRUE(readFile(serial) == readFile(parallel));
+    compare(parallel, testFile("autzen_trim.las"));
+
+    std::vector<char> points = makeLaz14(serial, 8, 2);
+    makeLaz14(parallel, 8, 2, 3);
+    EXPECT_TRUE(readFile(serial) == readFile(parallel));
+
+    reader::named_file f(parallel);
+    std::vector<char> laz(points.size());
+    f.readPoints(laz.data(), f.pointCount());
+    EXPECT_TRUE(laz == points);
+
+    std::remove(serial.c_str());
+    std::remove(parallel.c_str());
+}
+
+TEST(io_tests, can_write_points_in_bulk)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    io::header h;
+    std::ifstream in(testFile("autzen_trim.las"), std::ios::binary);
+    in.read((char *)&h, sizeof(h));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    writer::named_file::config c(h);
+    c.chunk_size = 10000;
+
+    std::string single(makeTempFileName());
+    {
+        writer::named_file f(single, c);
+        for (size_t i = 0; i < fin.count_; ++i)
+            f.writePoint(las.data() + i * fin.size_);
+        f.close();
+    }
+
+    for (unsigned threads : { 0, 2 })
+    {
+        // Batches that don't line up with the chunks.
+        std::string bulk(makeTempFileName());
+        writer::named_file f(bulk, c);
+        f.setThreads(threads);
+        const size_t BatchSize = 7777;
+        for (size_t i = 0; i < fin.count_; i += BatchSize)
+            f.writePoints(las.data() + i * fin.size_, (std::min)(BatchSize, fin.count_ - i));
+        f.close();
+
+        EXPECT_TRUE(readFile(single) == readFile(bulk)) << std::to_string(threads);
+        std::remove(bulk.c_str());
+    }
+
+    reader::named_file f(single);
+    reader::named_file orig(testFile("autzen_trim.las"));
+    EXPECT_NEAR(f.header().minimum.x, orig.header().minimum.x, h.scale.x);
+    EXPECT_NEAR(f.header().maximum.y, orig.header().maximum.y, h.scale.y);
+    EXPECT_NEAR(f.header().minimum.z, orig.header().minimum.z, h.scale.z);
+    std::vector<char> laz(las.size());
+    f.readPoints(laz.data(), f.pointCount());
+    EXPECT_TRUE(laz == las);
+    std::remove(single.c_str());
+}
+
+TEST(io_tests, can_write_variable_chunks)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    io::header h;
+    std::ifstream in(testFile("autzen_trim.las"), std::ios::binary);
+    in.read((char *)&h, sizeof(h));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    writer::named_file::config c(h);
+    c.chunk_size = io::VariableChunkSize;
+
+    // Chunks of 1, 2, 3... thousand points.
+    auto write = [&](const std::string& filename, unsigned threads)
+    {
+        writer::named_file f(filename, c);
+        f.setThreads(threads);
+        size_t pos = 0;
+        for (size_t size = 1000; pos < fin.count_; size += 1000)
+        {
+            size_t count = (std::min)(size, fin.count_ - pos);
+            f.writePoints(las.data() + pos * fin.size_, count);
+            f.flushChunk();
+            pos += count;
+        }
+        f.close();
+    };
+
+    std::string serial(makeTempFileName());
+    std::string parallel(makeTempFileName());
+    write(serial, 0);
+    write(parallel, 3);
+    EXPECT_TRUE(readFile(serial) == readFile(parallel));
+
+    reader::named_file f(serial);
+    std::vector<char> laz(las.size());
+    f.readPoints(laz.data(), f.pointCount());
+    EXPECT_TRUE(laz == las);
+
+    // The third chunk starts at point 6000.
+    std::vector<char> buf(fin.size_);
+    for (size_t i : { 5999, 6000, 100000 })
+    {
+        f.seek(i);
+        f.readPoint(buf.data());
+        EXPECT_EQ(memcmp(buf.data(), las.data() + i * fin.size_, fin.size_), 0) << i;
+    }
+
+    std::remove(serial.c_str());
+    std::remove(parallel.c_str());
+
+    // Fixed-size chunks can't be flushed.
+    c.chunk_size = 10000;
+    writer::named_file fixed(serial, c);
+    EXPECT_THROW(fixed.flushChunk(), error);
+    fixed.close();
+    std::remove(serial.c_str());
+}
+
+TEST(io_tests, can_size_chunks_by_bytes)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    io::header h;
+    std::ifstream in(testFile("autzen_trim.las"), std::ios::binary);
+    in.read((char *)&h, sizeof(h));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    writer::named_file::config c(h);
+    const uint32_t Budget = 64 * 1024;
+    {
+        // Fixed-size chunks can't be sized by bytes.
+        std::string filename(makeTempFileName());
+        writer::named_file out(filename, c);
+        EXPECT_THROW(out.setChunkBytes(Budget), error);
+        out.close();
+        std::remove(filename.c_str());
+    }
+
+    c.chunk_size = io::VariableChunkSize;
+    for (unsigned threads : { 0, 2 })
+    {
+        std::string filename(makeTempFileName());
+        writer::named_file out(filename, c);
+        out.setThreads(threads);
+        out.setChunkBytes(Budget);
+        out.writePoints(las.data(), fin.count_);
+        out.close();
+
+        // Pull the chunk table from the file.
+        std::vector<char> buf = readFile(filename);
+        io::header lazHeader;
+        memcpy(&lazHeader, buf.data(), sizeof(lazHeader));
+        int64_t tableOffset;
+        memcpy(&tableOffset, buf.data() + lazHeader.point_offset, sizeof(tableOffset));
+        uint32_t numChunks;
+        memcpy(&numChunks, buf.data() + tableOffset + 4, sizeof(numChunks));
+        InMemStream table(buf.data() + tableOffset + 8, buf.size() - tableOffset - 8);
+        std::vector<chunk> chunks = decompress_chunk_table(table.cb(), numChunks, true);
+
+        // Once the first chunk has been measured, chunks come close to the budget.
+        // With threads, several chunks are sized before the first is measured.
+        size_t measured = threads ? 2 * threads + 1 : 1;
+        EXPECT_GT(chunks.size(), measured + 1);
+        for (size_t i = measured; i < chunks.size() - 1; ++i)
+        {
+            EXPECT_GT(chunks[i].size, Budget * 3 / 4) << std::to_string(i);
+            EXPECT_LT(chunks[i].size, Budget * 5 / 4) << std::to_string(i);
+        }
+
+        reader::named_file f(filename);
+        std::vector<char> laz(las.size());
+        f.readPoints(laz.data(), f.pointCount());
+        EXPECT_TRUE(laz == las);
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(io_tests, can_skip_chunks_with_stats)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 6, 0);
+    io::header h;
+    {
+        reader::named_file f(filename);
+        h = f.header();
+    }
+    const size_t pointLen = h.point_record_length;
+    const size_t count = points.size() / pointLen;
+
+    writer::named_file::config c(h);
+    c.pdrf = 6;
+    c.minor_version = 4;
+    c.chunk_size = 5000;
+    {
+        writer::named_file out(filename, c);
+        out.setChunkStats(true);
+        out.writePoints(points.data(), count);
+        out.close();
+    }
+
+    double minTime = (std::numeric_limits<double>::max)();
+    double maxTime = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < count; ++i)
+    {
+        las::point14 q(points.data() + i * pointLen);
+        minTime = (std::min)(minTime, q.gpsTime());
+        maxTime = (std::max)(maxTime, q.gpsTime());
+    }
+
+    // The western quarter of the file, and the first quarter of the time range.
+    std::vector<reader::filter> filters(2);
+    filters[0].maximum.x = h.minimum.x + (h.maximum.x - h.minimum.x) / 4;
+    filters[1].max_gps_time = minTime + (maxTime - minTime) / 4;
+
+    for (const reader::filter& flt : filters)
+    for (unsigned threads : { 0, 2 })
+    {
+        auto passes = [&](const char *p)
+        {
+            las::point14 q(p);
+            return q.x() * h.scale.x + h.offset.x <= flt.maximum.x &&
+                q.gpsTime() <= flt.max_gps_time;
+        };
+        size_t expected = 0;
+        for (size_t i = 0; i < count; ++i)
+            if (passes(points.data() + i * pointLen))
+                expected++;
+        EXPECT_GT(expected, 0u);
+
+        reader::named_file f(filename);
+        f.setThreads(threads);
+        EXPECT_TRUE(f.setFilter(flt));
+        size_t filtered = f.filteredPointCount();
+        EXPECT_LT(filtered, count);
+
+        std::vector<char> laz(filtered * pointLen);
+        f.readPoints(laz.data(), filtered);
+        size_t found = 0;
+        for (size_t i = 0; i < filtered; ++i)
+            if (passes(laz.data() + i * pointLen))
+                found++;
+        EXPECT_EQ(found, expected) << std::to_string(threads);
+        EXPECT_THROW(f.readPoint(laz.data()), error);
+
+        // No points have this classification.
+        reader::filter none;
+        none.classes.push_back(255);
+        f.setFilter(none);
+        EXPECT_EQ(f.filteredPointCount(), 0u);
+
+        // Back to reading everything.
+        f.setFilter(reader::filter());
+        EXPECT_EQ(f.filteredPointCount(), count);
+        std::vector<char> all(points.size());
+        f.readPoints(all.data(), count);
+        EXPECT_TRUE(all == points) << std::to_string(threads);
+    }
+
+    // Without statistics nothing can be skipped.
+    {
+        writer::named_file out(filename, c);
+        out.writePoints(points.data(), count);
+        out.close();
+    }
+    reader::named_file f(filename);
+    EXPECT_FALSE(f.setFilter(filters[0]));
+    EXPECT_EQ(f.filteredPointCount(), count);
+    std::remove(filename.c_str());
+}
+
+namespace
+{
+
+// Pretends that more points have been written than really were.
+struct count_writer : public writer::named_file
+{
+    count_writer(const std::string& filename, const config& c) : named_file(filename, c)
+    {}
+
+    void addPhantomPoints(uint64_t count)
+    {
+        basic_file::p_->chunk_state.total_written += count;
+    }
+};
+
+} // unnamed namespace
+
+TEST(io_tests, writes_64bit_counts)
+{
+    std::string filename(makeTempFileName());
+    writer::named_file::config c({0.01, 0.01, 0.01}, {0.0, 0.0, 0.0});
+    c.minor_version = 4;
+
+    auto write = [&](uint64_t phantoms)
+    {
+        count_writer f(filename, c);
+        for (int r : { 1, 2, 6 })
+        {
+            std::vector<char> p(c.to_header().point_record_length);
+            if (c.pdrf >= 6)
+                p[14] = (char)r;
+            else
+                p[14] = (char)(r & 7);
+            f.writePoint(p.data());
+        }
+        f.addPhantomPoints(phantoms);
+        f.close();
+
+        io::header14 h;
+        std::ifstream in(filename, std::ios::binary);
+        in.read((char *)&h, sizeof(h));
+        return h;
+    };
+
+    // The legacy counts of PDRF 6-10 are always zero.
+    c.pdrf = 6;
+    io::header14 h = write(0);
+    EXPECT_EQ(h.point_count, 0u);
+    EXPECT_EQ(h.points_by_return[0], 0u);
+    EXPECT_EQ(h.point_count_14, 3u);
+    EXPECT_EQ(h.points_by_return_14[0], 1u);
+    EXPECT_EQ(h.points_by_return_14[1], 1u);
+    EXPECT_EQ(h.points_by_return_14[5], 1u);
+
+    c.pdrf = 1;
+    h = write(0);
+    EXPECT_EQ(h.point_count, 3u);
+    EXPECT_EQ(h.points_by_return[0], 1u);
+    EXPECT_EQ(h.points_by_return[1], 1u);
+    EXPECT_EQ(h.point_count_14, 3u);
+    EXPECT_EQ(h.points_by_return_14[5], 1u);
+
+    // Past 32 bits only the 1.4 counts are set.
+    const uint64_t Big = (uint64_t)1 << 32;
+    h = write(Big);
+    EXPECT_EQ(h.point_count, 0u);
+    EXPECT_EQ(h.points_by_return[0], 0u);
+    EXPECT_EQ(h.point_count_14, Big + 3);
+
+    c.minor_version = 2;
+    EXPECT_THROW(write(Big), error);
+    std::remove(filename.c_str());
+}
+
+namespace
+{
+
+// An output that can't seek or tell its position, like a pipe.
+struct pipebuf : public std::streambuf
+{
+    std::string data;
+
+    int_type overflow(int_type c)
+    {
+        if (c != traits_type::eof())
+            data.push_back(traits_type::to_char_type(c));
+        return c;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n)
+    {
+        data.append(s, (size_t)n);
+        return n;
+    }
+};
+
+// Accepts the first 'limit' bytes and fails every write after that.
+struct failbuf : public std::streambuf
+{
+    failbuf(size_t limit) : left(limit)
+    {}
+
+    size_t left;
+
+    int_type overflow(int_type c)
+    {
+        if (c == traits_type::eof() || left == 0)
+            return traits_type::eof();
+        left--;
+        return c;
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize n)
+    {
+        std::streamsize count = (std::min)(n, (std::streamsize)left);
+        left -= (size_t)count;
+        return count;
+    }
+};
+
+} // unnamed namespace
+
+TEST(io_tests, can_write_unseekable_output)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    // The counts and bounds have to be known up front.
+    reader::named_file orig(testFile("autzen_trim.las"));
+    io::header h = writer::named_file::config(orig.header()).to_header();
+    h.point_count = orig.header().point_count;
+    h.minimum = orig.header().minimum;
+    h.maximum = orig.header().maximum;
+
+    for (unsigned threads : { 0, 2 })
+    {
+        pipebuf buf;
+        std::ostream out(&buf);
+        writer::generic_file f(out, h, 10000, false);
+        f.setThreads(threads);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+        EXPECT_TRUE(out.good());
+
+        reader::mem_file r(&buf.data[0], buf.data.size());
+        EXPECT_EQ(r.pointCount(), fin.count_);
+        EXPECT_EQ(r.header().minimum.x, orig.header().minimum.x);
+        EXPECT_EQ(r.header().maximum.z, orig.header().maximum.z);
+        std::vector<char> laz(las.size());
+        r.readPoints(laz.data(), r.pointCount());
+        EXPECT_TRUE(laz == las) << std::to_string(threads);
+    }
+}
+
+// The counts of a streamed 1.4 file come from the 1.4 header the caller passes in.
+TEST(io_tests, can_write_unseekable_64bit_counts)
+{
+    writer::named_file::config c({0.01, 0.01, 0.01}, {0.0, 0.0, 0.0});
+    c.minor_version = 4;
+
+    auto write = [&](const io::header14& in)
+    {
+        pipebuf buf;
+        std::ostream out(&buf);
+        writer::generic_file f(out, in, 10000, false);
+        f.close();
+
+        io::header14 h;
+        memcpy(&h, buf.data.data(), sizeof(h));
+        return h;
+    };
+
+    io::header14 in;
+    c.pdrf = 6;
+    static_cast<io::header&>(in) = c.to_header();
+    in.point_count_14 = 5000000000;
+    in.points_by_return_14[0] = 4000000000;
+    in.points_by_return_14[14] = 1000000000;
+    io::header14 h = write(in);
+    EXPECT_EQ(h.point_count, 0u);
+    EXPECT_EQ(h.points_by_return[0], 0u);
+    EXPECT_EQ(h.point_count_14, 5000000000u);
+    EXPECT_EQ(h.points_by_return_14[0], 4000000000u);
+    EXPECT_EQ(h.points_by_return_14[14], 1000000000u);
+
+    // The legacy counts of a legacy format are set if the count fits.
+    c.pdrf = 1;
+    static_cast<io::header&>(in) = c.to_header();
+    in.point_count_14 = 7;
+    std::fill(in.points_by_return_14, in.points_by_return_14 + 15, 0);
+    in.points_by_return_14[1] = 7;
+    h = write(in);
+    EXPECT_EQ(h.point_count, 7u);
+    EXPECT_EQ(h.points_by_return[1], 7u);
+    EXPECT_EQ(h.point_count_14, 7u);
+    EXPECT_EQ(h.points_by_return_14[1], 7u);
+
+    in.point_count_14 = 5000000000;
+    in.points_by_return_14[1] = 5000000000;
+    h = write(in);
+    EXPECT_EQ(h.point_count, 0u);
+    EXPECT_EQ(h.points_by_return[1], 0u);
+    EXPECT_EQ(h.point_count_14, 5000000000u);
+
+    // A plain header's legacy counts stand in for the 1.4 counts.
+    io::header legacy = c.to_header();
+    legacy.point_count = 9;
+    legacy.points_by_return[0] = 9;
+    pipebuf buf;
+    std::ostream out(&buf);
+    writer::generic_file f(out, legacy, 10000, false);
+    f.close();
+    memcpy(&h, buf.data.data(), sizeof(h));
+    EXPECT_EQ(h.point_count, 9u);
+    EXPECT_EQ(h.points_by_return[0], 9u);
+    EXPECT_EQ(h.point_count_14, 9u);
+    EXPECT_EQ(h.points_by_return_14[0], 9u);
+}
+
+TEST(io_tests, can_write_to_memory)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file orig(testFile("autzen_trim.las"));
+    writer::named_file::config c(orig.header());
+    c.chunk_size = 10000;
+
+    std::string filename(makeTempFileName());
+    {
+        writer::named_file f(filename, c);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+    }
+    std::vector<char> expected = readFile(filename);
+
+    // Growable memory.
+    writer::mem_file grown(c.to_header(), c.chunk_size);
+    grown.writePoints(las.data(), fin.count_);
+    grown.close();
+    EXPECT_TRUE(std::vector<char>(grown.data(), grown.data() + grown.size()) == expected);
+
+    // Memory supplied by the caller.
+    std::vector<char> buf(expected.size());
+    writer::mem_file fixed(buf.data(), buf.size(), c.to_header(), c.chunk_size);
+    fixed.writePoints(las.data(), fin.count_);
+    fixed.close();
+    EXPECT_EQ(fixed.size(), expected.size());
+    EXPECT_TRUE(buf == expected);
+
+    // Memory that's too small.
+    std::vector<char> small(expected.size() / 2);
+    writer::mem_file overflow(small.data(), small.size(), c.to_header(), c.chunk_size);
+    EXPECT_THROW({
+        overflow.writePoints(las.data(), fin.count_);
+        overflow.close();
+    }, error);
+
+    // A mapped file, which is cut to size.
+    std::string mapped(makeTempFileName());
+    {
+        writer::named_file f(mapped, c, expected.size() * 2);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+    }
+    EXPECT_TRUE(readFile(mapped) == expected);
+}
+
+TEST(io_tests, can_write_asynchronously)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file orig(testFile("autzen_trim.las"));
+    writer::named_file::config c(orig.header());
+    c.chunk_size = 10000;
+
+    std::string filename(makeTempFileName());
+    {
+        writer::named_file f(filename, c);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+    }
+    std::vector<char> expected = readFile(filename);
+
+    for (unsigned threads : { 0, 2 })
+    {
+        std::string async(makeTempFileName());
+        {
+            writer::named_file f(async, c);
+            f.setThreads(threads);
+            f.setAsyncWrites(true);
+            f.writePoints(las.data(), fin.count_);
+            f.close();
+        }
+        EXPECT_TRUE(readFile(async) == expected) << std::to_string(threads);
+
+        // An output that can't seek.
+        io::header h = c.to_header();
+        h.point_count = orig.header().point_count;
+        h.minimum = orig.header().minimum;
+        h.maximum = orig.header().maximum;
+        pipebuf buf;
+        std::ostream out(&buf);
+        writer::generic_file f(out, h, c.chunk_size, false);
+        f.setThreads(threads);
+        f.setAsyncWrites(true);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+
+        reader::mem_file r(&buf.data[0], buf.data.size());
+        std::vector<char> laz(las.size());
+        r.readPoints(laz.data(), r.pointCount());
+        EXPECT_TRUE(laz == las) << std::to_string(threads);
+    }
+}
+
+// A failed write on the I/O thread is reported to the writer.
+TEST(io_tests, reports_asynchronous_write_errors)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file orig(testFile("autzen_trim.las"));
+    io::header h = writer::named_file::config(orig.header()).to_header();
+    h.point_count = orig.header().point_count;
+
+    for (bool exceptions : { false, true })
+    for (unsigned threads : { 0, 2 })
+    {
+        failbuf buf(100000);
+        std::ostream out(&buf);
+        if (exceptions)
+            out.exceptions(std::ios::badbit | std::ios::failbit);
+        writer::generic_file f(out, h, 10000, false);
+        f.setThreads(threads);
+        f.setAsyncWrites(true);
+        if (exceptions)
+            EXPECT_THROW({ f.writePoints(las.data(), fin.count_); f.close(); },
+                std::ios_base::failure) << std::to_string(threads);
+        else
+            EXPECT_THROW({ f.writePoints(las.data(), fin.count_); f.close(); },
+                error) << std::to_string(threads);
+    }
+}
+
+TEST(io_tests, can_append_points)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+
+    reader::named_file orig(testFile("autzen_trim.las"));
+    writer::named_file::config c(orig.header());
+    c.chunk_size = 10000;
+
+    std::string filename(makeTempFileName());
+    {
+        writer::named_file f(filename, c);
+        f.writePoints(las.data(), fin.count_);
+        f.close();
+    }
+    std::vector<char> expected = readFile(filename);
+
+    // Appending in pieces makes the same file as writing in one go, whether or not
+    // the last chunk is full.
+    for (size_t first : { (size_t)25000, (size_t)30000 })
+    for (unsigned threads : { 0, 2 })
+    {
+        std::string appended(makeTempFileName());
+        {
+            writer::named_file f(appended, c);
+            f.writePoints(las.data(), first);
+            f.close();
+        }
+        {
+            writer::named_file f(appended);
+            f.setThreads(threads);
+            f.writePoints(las.data() + first * fin.size_, fin.count_ - first);
+            f.close();
+        }
+        EXPECT_TRUE(readFile(appended) == expected) <<
+            std::to_string(first) << "/" << std::to_string(threads);
+    }
+
+    // Variable chunks and chunk statistics.
+    std::string filename14(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename14, 6, 0);
+    io::header h;
+    {
+        reader::named_file f(filename14);
+        h = f.header();
+    }
+    const size_t pointLen = h.point_record_length;
+    const size_t count = points.size() / pointLen;
+
+    writer::named_file::config c14(h);
+    c14.pdrf = 6;
+    c14.minor_version = 4;
+    c14.chunk_size = io::VariableChunkSize;
+    {
+        writer::named_file f(filename14, c14);
+        f.setChunkStats(true);
+        f.writePoints(points.data(), count / 2);
+        f.close();
+    }
+
+    // Add an EVLR of another tool's and some stale bytes past it.
+    const std::string wkt("PROJCS[\"NAD83 / Oregon GIC Lambert (ft)\"]");
+    {
+        std::vector<char> buf = readFile(filename14);
+        io::header14 h14;
+        memcpy(&h14, buf.data(), sizeof(h14));
+        vlr::evlr_header eh {};
+        memcpy(eh.user_id, "LASF_Projection", 15);
+        eh.record_id = 2112;
+        eh.record_length_after_header = wkt.size();
+        buf.insert(buf.end(), (char *)&eh, (char *)&eh + sizeof(eh));
+        buf.insert(buf.end(), wkt.begin(), wkt.end());
+        h14.elvr_count++;
+        memcpy(buf.data(), &h14, sizeof(h14));
+        buf.insert(buf.end(), 1 << 20, (char)0xAB);
+
+        std::ofstream out(filename14, std::ios::binary | std::ios::trunc);
+        out.write(buf.data(), buf.size());
+    }
+
+    {
+        writer::named_file f(filename14);
+        f.writePoints(points.data() + count / 2 * pointLen, count - count / 2);
+        f.close();
+    }
+
+    // The EVLR is kept and the file ends with the last EVLR.
+    {
+        std::vector<char> buf = readFile(filename14);
+        io::header14 h14;
+        memcpy(&h14, buf.data(), sizeof(h14));
+        EXPECT_EQ(h14.elvr_count, 2u);
+        uint64_t pos = h14.evlr_offset;
+        bool found = false;
+        for (uint32_t i = 0; i < h14.elvr_count; ++i)
+        {
+            vlr::evlr_header eh;
+            memcpy(&eh, buf.data() + pos, sizeof(eh));
+            pos += sizeof(eh);
+            if (eh.record_id == 2112)
+                found = (std::string(buf.data() + pos,
+                    (size_t)eh.record_length_after_header) == wkt);
+            pos += eh.record_length_after_header;
+        }
+        EXPECT_TRUE(found);
+        EXPECT_EQ(pos, buf.size());
+    }
+
+    reader::named_file r(filename14);
+    EXPECT_EQ(r.pointCount(), count);
+    EXPECT_EQ(r.chunks().size(), 2u);
+    EXPECT_EQ(r.chunkStats().size(), 2u);
+    EXPECT_EQ(r.header().minimum.x, h.minimum.x);
+    EXPECT_EQ(r.header().maximum.y, h.maximum.y);
+    std::vector<char> read(points.size());
+    r.readPoints(read.data(), count);
+    EXPECT_TRUE(read == points);
+
+    // Uncompressed files can't be appended to.
+    EXPECT_THROW(writer::named_file f(testFile("autzen_trim.las")), error);
+}
+
+TEST(io_tests, can_reset_coders)
+{
+    checkExists(testFile("autzen_trim.las"));
+
+    auto check = [](int format, int ebCount, const std::vector<char>& las, size_t len)
+    {
+        const size_t count = las.size() / len;
+        const size_t half = count / 2;
+        const std::string msg = std::to_string(format);
+
+        // Two chunks from one compressor that's reset in between.
+        std::vector<unsigned char> out;
+        auto cb = [&out](const unsigned char *b, size_t n)
+            { out.insert(out.end(), b, b + n); };
+        las_compressor::ptr c = build_las_compressor(cb, format, ebCount);
+        for (size_t i = 0; i < half; ++i)
+            c->compress(las.data() + i * len);
+        c->done();
+        const size_t firstSize = out.size();
+        c->reset();
+        for (size_t i = half; i < count; ++i)
+            c->compress(las.data() + i * len);
+        c->done();
+
+        // The second chunk is just what a new compressor produces.
+        std::vector<unsigned char> fresh;
+        auto freshCb = [&fresh](const unsigned char *b, size_t n)
+            { fresh.insert(fresh.end(), b, b + n); };
+        las_compressor::ptr c2 = build_las_compressor(freshCb, format, ebCount);
+        for (size_t i = half; i < count; ++i)
+            c2->compress(las.data() + i * len);
+        c2->done();
+        EXPECT_EQ(out.size() - firstSize, fresh.size()) << msg;
+        EXPECT_EQ(memcmp(out.data() + firstSize, fresh.data(), fresh.size()), 0) << msg;
+
+        // Both chunks decode with one decompressor.
+        InMemStream in((const char *)out.data(), out.size());
+        las_decompressor::ptr d = build_las_decompressor(in, format, ebCount);
+        std::vector<char> point(len);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i == half)
+            {
+                in.seek(firstSize);
+                d->reset();
+            }
+            d->decompress(point.data());
+            EXPECT_EQ(memcmp(point.data(), las.data() + i * len, len), 0) << msg << "/" <<
+                std::to_string(i);
+        }
+    };
+
+    test::reader fin(testFile("autzen_trim.las"));
+    std::vector<char> las(fin.count_ * fin.size_);
+    for (size_t i = 0; i < fin.count_; ++i)
+        fin.record(las.data() + i * fin.size_);
+    check(3, 0, las, fin.size_);
+
+    std::string filename(makeTempFileName());
+    std::vector<char> points = makeLaz14(filename, 8, 3);
+    check(8, 3, points, points.size() / fin.count_);
+}
+
 TEST(io_tests, writes_bbox_to_header)
 {
     // First write a few points
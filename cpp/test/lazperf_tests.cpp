@@ -35,6 +35,7 @@
 
 #include <ctime>
 #include <fstream>
+#include <iterator>
 
 #include <lazperf/encoder.hpp>
 #include <lazperf/decoder.hpp>
@@ -423,6 +424,34 @@ TEST(lazperf_tests, dynamic_compressor_works) {
 }
 
 
+TEST(lazperf_tests, compressor_output_comes_in_blocks)
+{
+    std::ifstream f(testFile("point10-1.las.raw"), std::ios::binary);
+    std::ifstream fc(testFile("point10-1.las.laz.raw"), std::ios::binary);
+    if (!f.good() || !fc.good())
+        FAIL() << "Raw test files not available.";
+    std::vector<char> las((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    std::vector<char> laz((std::istreambuf_iterator<char>(fc)), std::istreambuf_iterator<char>());
+
+    std::vector<unsigned char> out;
+    size_t calls = 0;
+    auto cb = [&out, &calls](const unsigned char *b, size_t len)
+    {
+        out.insert(out.end(), b, b + len);
+        calls++;
+    };
+    las_compressor::ptr c = build_las_compressor(cb, 0);
+    for (size_t pos = 0; pos + sizeof(las::point10) <= las.size(); pos += sizeof(las::point10))
+        c->compress(las.data() + pos);
+    c->done();
+
+    // The encoder fills 1K buffers, which are passed on together.
+    EXPECT_EQ(calls, out.size() / OutCbStream::BlockSize + 1);
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), laz.begin(),
+        [](unsigned char a, char b){ return a == (unsigned char)b; }));
+}
+
+
 TEST(lazperf_tests, dynamic_decompressor_can_decode_laszip_buffer) {
 
 	std::ifstream f(testFile("point10-1.las.laz.raw"), std::ios::binary);